@@ -0,0 +1,532 @@
+#include "codegen/submit.hpp"
+#include "render/band-encoder.hpp"
+#include "render/compositor.hpp"
+#include "render/frame.hpp"
+#include "render/screen.hpp"
+
+#include "util/buffer/draw.hpp"
+
+#include "vt/parser.hpp"
+
+#include <atomic>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// counts every allocation the pipeline makes, the band workers allocate too so the counter is atomic
+static std::atomic<uintmax_t> alloc_c = 0;
+
+// sanitizers replace malloc themselves, the interposer is left out there and the count stays 0
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define BENCH_SANITIZED
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define BENCH_SANITIZED
+#endif
+#endif
+
+// glibc keeps the real allocator reachable under __libc_*
+#if !defined(BENCH_SANITIZED)
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+    alloc_c.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    alloc_c.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    alloc_c.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+}
+#endif
+
+constexpr uintmax_t WIDTH = 200;
+constexpr uintmax_t HEIGHT = 60;
+
+constexpr uintmax_t WARMUP_FRAME_C = 16;
+constexpr uintmax_t FRAME_C = 512;
+
+constexpr uintmax_t BAND_C = 4;
+
+constexpr uintmax_t TABLE_COLUMN_C = 16;
+
+constexpr uintmax_t POPUP_WIDTH = 60;
+constexpr uintmax_t POPUP_HEIGHT = 16;
+
+// frames replayed through Vt::Terminal after timing
+constexpr uintmax_t VERIFY_FRAME_C = 32;
+
+struct Context {
+    Tesix::Render::Frame _frame;
+    Tesix::Render::BandEncoder _encoder;
+    Tesix::Render::Screen _screen;
+    Tesix::StyledBuffer _back;
+
+    // the back buffer is composed from these by the overlay workload
+    Tesix::Render::Compositor _compositor;
+    Tesix::StyledBuffer _base;
+    Tesix::StyledBuffer _popup;
+
+    Tesix::Codegen::State _state;
+
+    uintmax_t _fd;
+};
+
+struct Benchmark {
+    const char* _name;
+
+    // cells the workload touches per frame, used for ns/cell
+    uintmax_t _cell_c;
+
+    void (*_frame)(Context& ctx, const uintmax_t frame_i);
+
+    // false if the workload submits instructions itself instead of presenting _back, its screen is not checked
+    bool _presents_back;
+};
+
+struct Verification {
+    uintmax_t _sequence_c;
+    uintmax_t _unsupported_c;
+
+    // first frame whose screen differed from _back, VERIFY_FRAME_C if all matched
+    uintmax_t _mismatch_frame_i;
+    Tesix::Position _mismatch;
+};
+
+static inline uint64_t styleFg(
+    const uint8_t r,
+    const uint8_t g,
+    const uint8_t b
+) {
+    return Tesix::Style::Style().fgFullColor({._r = r, ._g = g, ._b = b}).toEncoding();
+}
+
+static inline uint64_t styleBg(
+    const uint8_t r,
+    const uint8_t g,
+    const uint8_t b
+) {
+    return Tesix::Style::Style().bgFullColor({._r = r, ._g = g, ._b = b, ._a = 15}).toEncoding();
+}
+
+static inline uint32_t xorshift(
+    uint32_t& seed
+) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    return seed;
+}
+
+// text with a handful of styles, like an editor with syntax highlighting
+static void drawText(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    const Tesix::Style::StyleContainer styles[] = {
+        Tesix::Style::StyleContainer::createValue(styleFg(200, 200, 200)),
+        Tesix::Style::StyleContainer::createValue(styleFg(250, 120, 40)),
+        Tesix::Style::StyleContainer::createValue(styleFg(80, 160, 250)),
+        Tesix::Style::StyleContainer::createValue(Tesix::Style::Style().bold().fgFullColor({._r = 120, ._g = 220, ._b = 90}).toEncoding()),
+    };
+
+    for(uintmax_t y = 0; y < HEIGHT; y++) {
+        for(uintmax_t x = 0; x < WIDTH; x++) {
+            const uintmax_t word = (x + y * 7 + frame_i) / 6;
+
+            const uint32_t ch = (x + frame_i) % 6 == 0 ? ' ' : 'a' + (x * 31 + y + frame_i) % 26;
+
+            Tesix::Draw::drawCharacter(ctx._back, ch, styles[word % 4], Tesix::Position::create(x, y));
+        }
+    }
+
+    ctx._screen.invalidate();
+}
+
+static void frameFullDraw(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    drawText(ctx, frame_i);
+
+    Tesix::Render::submitFrame(ctx._frame, ctx._state, ctx._screen, ctx._back);
+}
+
+// the same frames encoded in BAND_C row bands on worker threads
+static void frameFullDrawBands(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    drawText(ctx, frame_i);
+
+    Tesix::Render::submitFrame(ctx._frame, ctx._encoder, ctx._state, ctx._screen, ctx._back);
+}
+
+// a few cells change between frames, like a clock or a cursor blinking in a mostly static UI
+static void frameSparse(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    const auto style = Tesix::Style::StyleContainer::createValue(styleFg(200, 200, 200));
+
+    uint32_t seed = frame_i * 2654435761u + 1;
+
+    for(uintmax_t i = 0; i < WIDTH * HEIGHT / 100; i++) {
+        const uintmax_t x = xorshift(seed) % WIDTH;
+        const uintmax_t y = xorshift(seed) % HEIGHT;
+
+        Tesix::Draw::drawCharacter(ctx._back, 'a' + xorshift(seed) % 26, style, Tesix::Position::create(x, y));
+    }
+
+    Tesix::Render::submitFrame(ctx._frame, ctx._state, ctx._screen, ctx._back);
+}
+
+// static text redrawn every frame, with modifiers toggled on a few cells per row
+// a modifier flips one high bit of the style, rows that differ only in those must not hash alike
+static void frameModifiers(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    const auto plain = Tesix::Style::StyleContainer::createValue(styleFg(200, 200, 200));
+
+    const Tesix::Style::StyleContainer modified[] = {
+        Tesix::Style::StyleContainer::createValue(Tesix::Style::Style().strikethrough().fgFullColor({._r = 200, ._g = 200, ._b = 200}).toEncoding()),
+        Tesix::Style::StyleContainer::createValue(Tesix::Style::Style().reverse().fgFullColor({._r = 200, ._g = 200, ._b = 200}).toEncoding()),
+        Tesix::Style::StyleContainer::createValue(Tesix::Style::Style().blinking().fgFullColor({._r = 200, ._g = 200, ._b = 200}).toEncoding()),
+        Tesix::Style::StyleContainer::createValue(Tesix::Style::Style().strikethrough().reverse().fgFullColor({._r = 200, ._g = 200, ._b = 200}).toEncoding()),
+    };
+
+    uint32_t seed = frame_i * 2654435761u + 1;
+
+    for(uintmax_t y = 0; y < HEIGHT; y++) {
+        for(uintmax_t x = 0; x < WIDTH; x++) {
+            Tesix::Draw::drawCharacter(ctx._back, 'a' + (x * 31 + y) % 26, plain, Tesix::Position::create(x, y));
+        }
+
+        const auto& style = modified[xorshift(seed) % 4];
+
+        for(uintmax_t i = 0; i < 2; i++) {
+            const uintmax_t x = xorshift(seed) % WIDTH;
+
+            Tesix::Draw::drawCharacter(ctx._back, 'a' + (x * 31 + y) % 26, style, Tesix::Position::create(x, y));
+        }
+    }
+
+    Tesix::Render::submitFrame(ctx._frame, ctx._state, ctx._screen, ctx._back);
+}
+
+// every cell gets its own background color, like examples/colors.cpp on the whole screen
+static void frameGradient(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    for(uintmax_t y = 0; y < HEIGHT; y++) {
+        for(uintmax_t x = 0; x < WIDTH; x++) {
+            const auto style = Tesix::Style::StyleContainer::createValue(styleBg(
+                        static_cast<uint8_t>(x + frame_i),
+                        static_cast<uint8_t>(y * 4),
+                        static_cast<uint8_t>(frame_i)
+                    ));
+
+            Tesix::Draw::drawCharacter(ctx._back, ' ', style, Tesix::Position::create(x, y));
+        }
+    }
+
+    ctx._screen.invalidate();
+
+    Tesix::Render::submitFrame(ctx._frame, ctx._state, ctx._screen, ctx._back);
+}
+
+// a translucent popup slides over static text and gets a character typed into it every frame
+static void frameOverlay(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    Tesix::Render::Layer& popup = ctx._compositor._layers[1];
+
+    if(frame_i == 0) {
+        const auto text = Tesix::Style::StyleContainer::createValue(
+                    Tesix::Style::Style().fgFullColor({._r = 200, ._g = 200, ._b = 200}).bgFullColor({._r = 20, ._g = 20, ._b = 30, ._a = 15}).toEncoding()
+                );
+
+        for(uintmax_t y = 0; y < HEIGHT; y++) {
+            for(uintmax_t x = 0; x < WIDTH; x++) {
+                Tesix::Draw::drawCharacter(ctx._base, 'a' + (x * 31 + y) % 26, text, Tesix::Position::create(x, y));
+            }
+        }
+
+        Tesix::Draw::fill(ctx._popup, ' ', Tesix::Style::StyleContainer::createValue(
+                    Tesix::Style::Style().bgFullColor({._r = 40, ._g = 60, ._b = 160, ._a = 10}).toEncoding()
+                ));
+    }
+
+    const auto typed = Tesix::Style::StyleContainer::createValue(
+                Tesix::Style::Style().bold().fgFullColor({._r = 250, ._g = 250, ._b = 250}).bgFullColor({._r = 40, ._g = 60, ._b = 160, ._a = 15}).toEncoding()
+            );
+
+    Tesix::Draw::drawCharacter(ctx._popup, 'a' + frame_i % 26, typed, Tesix::Position::create(1 + frame_i % (POPUP_WIDTH - 2), 1 + frame_i / (POPUP_WIDTH - 2) % (POPUP_HEIGHT - 2)));
+
+    popup._pos = Tesix::Position::create(frame_i / 4 % (WIDTH - POPUP_WIDTH), 10);
+
+    Tesix::Render::compose(ctx._compositor, ctx._back);
+
+    Tesix::Render::submitFrame(ctx._frame, ctx._state, ctx._screen, ctx._back);
+}
+
+// a table of short UTF-8 strings redrawn every frame, like a process list or a log view
+static void frameTable(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    static const char* const cells[] = {
+        "kworker/0:1", "1024", "S", "0.3%", "12:04.11", "/usr/bin/zsh", "naïve café", "日本語の行",
+    };
+
+    const auto style = Tesix::Style::StyleContainer::createValue(styleFg(200, 200, 200));
+
+    for(uintmax_t y = 0; y < HEIGHT; y++) {
+        for(uintmax_t column = 0; column < TABLE_COLUMN_C; column++) {
+            const char* const text = cells[(y + column + frame_i) % 8];
+
+            Tesix::Draw::drawString(ctx._back, Tesix::asByteStr(text), strlen(text), style, Tesix::Position::create(column * (WIDTH / TABLE_COLUMN_C), y));
+        }
+    }
+
+    Tesix::Render::submitFrame(ctx._frame, ctx._state, ctx._screen, ctx._back);
+}
+
+static void submitLines(
+    Context& ctx,
+    const uint32_t* const line,
+    const uintmax_t line_c
+) {
+    const auto style = Tesix::Style::StyleContainer::createValue(styleFg(200, 200, 200));
+
+    for(uintmax_t y = 0; y < HEIGHT; y++) {
+        Tesix::Codegen::submitInstruction(ctx._frame._out, ctx._frame._instrs, ctx._state, Tesix::Codegen::Instruction::createString({
+            ._area = {
+                ._pos = {._x = 0, ._y = y},
+                ._len = line_c - y % 8
+            },
+            ._str = line + y % 8,
+            ._style = style
+        }), Tesix::Out::MEMORY_SINK);
+    }
+
+    // the instructions borrow line, which lives on the caller's stack
+    Tesix::Out::emptyInstructionBuffer(ctx._frame._out, ctx._frame._instrs, Tesix::Out::MEMORY_SINK);
+}
+
+static void frameASCII(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    uint32_t line[WIDTH + 8];
+
+    for(uintmax_t i = 0; i < WIDTH + 8; i++) {
+        line[i] = 'A' + (i * 7 + frame_i) % 58;
+    }
+
+    submitLines(ctx, line, WIDTH);
+}
+
+static void frameCJK(
+    Context& ctx,
+    const uintmax_t frame_i
+) {
+    uint32_t line[WIDTH / 2 + 8];
+
+    for(uintmax_t i = 0; i < WIDTH / 2 + 8; i++) {
+        line[i] = 0x4e00 + (i * 131 + frame_i) % 0x5000;
+    }
+
+    submitLines(ctx, line, WIDTH / 2);
+}
+
+static inline uint64_t nowNs() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief replays the workload's first frames through a headless terminal
+ * checks that the screen shows _back after every frame and counts the sequences it took
+ **/
+static Verification verify(
+    Context& ctx,
+    const Benchmark& bench
+) {
+    {
+        ctx._state = Tesix::Codegen::State::initial();
+        ctx._screen.invalidate();
+
+        Tesix::Draw::fill(ctx._back, ' ', Tesix::Style::StyleContainer::createValue(0));
+    }
+
+    Tesix::Vt::Terminal term = Tesix::Vt::Terminal::init(WIDTH, HEIGHT);
+
+    Verification result = {
+        ._sequence_c = 0,
+        ._unsupported_c = 0,
+        ._mismatch_frame_i = VERIFY_FRAME_C,
+        ._mismatch = Tesix::Vt::NO_MISMATCH
+    };
+
+    for(uintmax_t i = 0; i < VERIFY_FRAME_C; i++) {
+        Tesix::Render::beginFrame(ctx._frame);
+
+        bench._frame(ctx, i);
+
+        Tesix::Render::finishFrame(ctx._frame);
+
+        Tesix::Vt::feed(term, ctx._frame._out._ptr, ctx._frame._out._n);
+
+        ctx._frame._out._n = 0;
+
+        if(bench._presents_back && result._mismatch_frame_i == VERIFY_FRAME_C) {
+            const Tesix::Position mismatch = Tesix::Vt::findMismatch(term, ctx._back.all(), Tesix::Position::create(0, 0));
+
+            if(!(mismatch == Tesix::Vt::NO_MISMATCH)) {
+                result._mismatch_frame_i = i;
+                result._mismatch = mismatch;
+            }
+        }
+    }
+
+    result._sequence_c = term._stats._sequence_c;
+    result._unsupported_c = term._stats._unsupported_c + term._stats._invalid_c;
+
+    ctx._state.free();
+
+    return result;
+}
+
+static void run(
+    Context& ctx,
+    const Benchmark& bench
+) {
+    {
+        ctx._state = Tesix::Codegen::State::initial();
+        ctx._screen.invalidate();
+
+        Tesix::Draw::fill(ctx._back, ' ', Tesix::Style::StyleContainer::createValue(0));
+    }
+
+    uint64_t ns = 0;
+    uintmax_t bytes = 0;
+    uintmax_t allocs = 0;
+
+    for(uintmax_t i = 0; i < WARMUP_FRAME_C + FRAME_C; i++) {
+        const uintmax_t alloc_start = alloc_c.load(std::memory_order_relaxed);
+        const uint64_t start = nowNs();
+
+        Tesix::Render::beginFrame(ctx._frame);
+
+        bench._frame(ctx, i);
+
+        Tesix::Out::emptyInstructionBuffer(ctx._frame._out, ctx._frame._instrs, Tesix::Out::MEMORY_SINK);
+
+        const uintmax_t frame_bytes = ctx._frame._out._n;
+
+        Tesix::Render::endFrame(ctx._frame, ctx._fd);
+
+        if(i >= WARMUP_FRAME_C) {
+            ns += nowNs() - start;
+            bytes += frame_bytes;
+            allocs += alloc_c.load(std::memory_order_relaxed) - alloc_start;
+        }
+    }
+
+    ctx._state.free();
+
+    const Verification verification = verify(ctx, bench);
+
+    printf("%-12s %10.2f ns/cell %10ju bytes/frame %8.2f allocs/frame %8.1f seqs/frame",
+           bench._name,
+           static_cast<double>(ns) / (FRAME_C * bench._cell_c),
+           bytes / FRAME_C,
+           static_cast<double>(allocs) / FRAME_C,
+           static_cast<double>(verification._sequence_c) / VERIFY_FRAME_C);
+
+    if(verification._unsupported_c > 0) {
+        printf("  %ju unsupported", verification._unsupported_c);
+    }
+
+    if(verification._mismatch_frame_i < VERIFY_FRAME_C) {
+        printf("  MISMATCH frame %ju at %ju,%ju", verification._mismatch_frame_i, verification._mismatch._x, verification._mismatch._y);
+    }
+
+    printf("\n");
+}
+
+int main(
+    int argc,
+    char** argv
+) {
+    const Benchmark benchmarks[] = {
+        {._name = "full-draw", ._cell_c = WIDTH * HEIGHT, ._frame = frameFullDraw, ._presents_back = true},
+        {._name = "full-draw-4t", ._cell_c = WIDTH * HEIGHT, ._frame = frameFullDrawBands, ._presents_back = true},
+        {._name = "sparse", ._cell_c = WIDTH * HEIGHT / 100, ._frame = frameSparse, ._presents_back = true},
+        {._name = "modifiers", ._cell_c = WIDTH * HEIGHT, ._frame = frameModifiers, ._presents_back = true},
+        {._name = "gradient", ._cell_c = WIDTH * HEIGHT, ._frame = frameGradient, ._presents_back = true},
+        {._name = "table", ._cell_c = TABLE_COLUMN_C * HEIGHT, ._frame = frameTable, ._presents_back = true},
+        {._name = "overlay", ._cell_c = POPUP_WIDTH * POPUP_HEIGHT, ._frame = frameOverlay, ._presents_back = true},
+        {._name = "ascii", ._cell_c = WIDTH * HEIGHT, ._frame = frameASCII, ._presents_back = false},
+        {._name = "cjk", ._cell_c = WIDTH / 2 * HEIGHT, ._frame = frameCJK, ._presents_back = false},
+    };
+
+    const int fd = open("/dev/null", O_WRONLY);
+
+    if(fd < 0) {
+        perror("open /dev/null");
+        return 1;
+    }
+
+    Context ctx = {
+        ._frame = Tesix::Render::Frame::alloc(4096, 256, true),
+        ._encoder = Tesix::Render::BandEncoder::alloc(BAND_C),
+        ._screen = Tesix::Render::Screen::init(WIDTH, HEIGHT),
+        ._back = Tesix::StyledBuffer::init(WIDTH, HEIGHT),
+        ._compositor = Tesix::Render::Compositor::alloc(WIDTH, HEIGHT, 2),
+        ._base = Tesix::StyledBuffer::init(WIDTH, HEIGHT),
+        ._popup = Tesix::StyledBuffer::init(POPUP_WIDTH, POPUP_HEIGHT),
+        ._state = Tesix::Codegen::State::initial(),
+        ._fd = static_cast<uintmax_t>(fd)
+    };
+
+    Tesix::Render::pushLayer(ctx._compositor, ctx._base, Tesix::Position::create(0, 0));
+    Tesix::Render::pushLayer(ctx._compositor, ctx._popup, Tesix::Position::create(0, 10));
+
+    for(const Benchmark& bench : benchmarks) {
+        if(argc > 1 && strcmp(argv[1], bench._name) != 0) {
+            continue;
+        }
+
+        run(ctx, bench);
+    }
+
+    ctx._frame.free();
+    ctx._encoder.free();
+    ctx._compositor.free();
+
+    close(fd);
+}
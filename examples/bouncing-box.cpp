@@ -1,8 +1,23 @@
 #include "codegen/submit.hpp"
+#include "render/frame.hpp"
+#include "render/pacer.hpp"
+#include "render/screen.hpp"
 
 #include "util/buffer/draw.hpp"
 #include "util/term.hpp"
 
+#include <signal.h>
+#include <unistd.h>
+
+// the shell shares stdout's file description, it must not be left nonblocking
+static void onInterrupt(
+    int sig
+) {
+    Tesix::disableNonblocking(STDOUT_FILENO);
+
+    _exit(0);
+}
+
 int main() {
     Tesix::enableRawMode();
 
@@ -13,6 +28,12 @@ int main() {
 
     const uintmax_t fd = STDOUT_FILENO;
 
+    // the pacer learns that the terminal falls behind from writes that would block
+    Tesix::enableNonblocking(fd);
+
+    signal(SIGINT, onInterrupt);
+    signal(SIGTERM, onInterrupt);
+
     const uint64_t bg_enc = Tesix::Style::Style().bgFullColor({._r = 0, ._g = 0, ._b = 0, ._a = 15}).toEncoding();
     const auto bg_cont = Tesix::Style::StyleContainer::createValue(bg_enc);
 
@@ -25,8 +46,19 @@ int main() {
         Tesix::Draw::fill(window_buf.all(), '#', red_green_cont);
     }
 
+    auto back_buf = Tesix::StyledBuffer::init(240, 56);
+    auto screen = Tesix::Render::Screen::init(240, 56);
+
+    auto frame = Tesix::Render::Frame::alloc(4096, 100, true);
+
+    // at most 10 frames a second, down to 1 when the terminal falls behind
+    auto pacer = Tesix::Render::FramePacer::init(100000000, 1000000000, 16384);
+
     {
-        Tesix::Out::streamInstruction(out_buf, instr_buf, Tesix::Out::Instruction::createCursorPositionAbsolute(Tesix::Position::create(0, 0)), fd);
+        Tesix::Codegen::submitInstruction(out_buf, instr_buf, state, Tesix::Codegen::Instruction::createEraseDisplay({._style = bg_cont}), fd);
+
+        Tesix::Out::emptyInstructionBuffer(out_buf, instr_buf, fd);
+        Tesix::Out::emptyOutBuffer(out_buf, fd);
     }
 
     uintmax_t x = 0;
@@ -36,44 +68,35 @@ int main() {
     intmax_t y_vel = 1;
 
     while(true) {
+        Tesix::Render::waitFrameDue(pacer, frame, fd);
 
-        { // setup frame
-            Tesix::Codegen::submitInstruction(out_buf, instr_buf, state, Tesix::Codegen::Instruction::createEraseDisplay({._style = bg_cont}), fd);
-
-            Tesix::Out::emptyInstructionBuffer(out_buf, instr_buf, fd);
-            Tesix::Out::emptyOutBuffer(out_buf, fd);
+        { // draw frame
+            Tesix::Draw::fill(back_buf, ' ', bg_cont);
+            Tesix::Draw::drawBuffer(back_buf, window_buf.all(), Tesix::Position::create(x, y));
         }
 
-        { // draw window
-            const auto draw_window_instr = Tesix::Codegen::Instruction::createDrawBuffer({
-                ._pos = {x, y + 1},
-                ._contents = window_buf.all()
-            });
-
-            Tesix::Codegen::submitInstruction(out_buf, instr_buf, state, draw_window_instr, fd);
-            Tesix::Out::streamInstruction(out_buf, instr_buf, Tesix::Out::Instruction::createCursorPositionAbsolute(Tesix::Position::create(0, 0)), fd);
-
-            Tesix::Out::emptyInstructionBuffer(out_buf, instr_buf, fd);
-            Tesix::Out::emptyOutBuffer(out_buf, fd);
+        { // present frame
+            Tesix::Render::beginFrame(frame);
+            Tesix::Render::submitFrame(frame, state, screen, back_buf);
+            Tesix::Render::endFramePaced(pacer, frame, fd);
         }
 
         { // move window
             x += x_vel;
             y += y_vel;
 
-            if(x == 0 || x + window_buf._ch._box._width >= 240) {
+            if(x == 0 || x + window_buf.box()._width >= back_buf.box()._width) {
                 x_vel = -x_vel;
             }
 
-            if(y == 0 || y + window_buf._ch._box._height >= 56) {
+            if(y == 0 || y + window_buf.box()._height >= back_buf.box()._height) {
                 y_vel = -y_vel;
             }
         }
-
-        Tesix::msleep(100);
-
     }
 
     out_buf.free();
     instr_buf.free();
+    frame.free();
+    state.free();
 }
@@ -52,4 +52,5 @@ int main() {
 
     out_buf.free();
     instr_buf.free();
+    state.free();
 }
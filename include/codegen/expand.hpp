@@ -2,3 +2,4 @@
 
 #include "codegen/expand/fill-area.hpp"
 #include "codegen/expand/draw-buffer.hpp"
+#include "codegen/expand/diff-buffer.hpp"
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "codegen/instruction.hpp"
+#include "codegen/instruction-stream.hpp"
+#include "codegen/optimize/string-repeat.hpp"
+
+namespace Tesix {
+
+namespace Codegen {
+
+static inline bool isCellChanged(
+    const DiffBufferParams& params,
+    const bool same_keys,
+    const Position& pos
+) {
+    if(params._contents.ch(pos) != params._previous.ch(pos)) {
+        return true;
+    }
+
+    if(same_keys) {
+        return params._contents.styleKey(pos) != params._previous.styleKey(pos);
+    }
+
+    return params._contents.styleValue(pos) != params._previous.styleValue(pos);
+}
+
+static void expandDiffBuffer(
+    InstructionStream& instrs,
+    const DiffBufferParams& params
+) {
+    assert(params._contents.box() == params._previous.box());
+
+    const Box& box = params._contents.box();
+    const Position& origin = params._contents.bounds()._pos;
+
+    const DirtyRows* const dirty = params._dirty;
+
+    const bool same_keys = params._contents.sharesStyleKeys(params._previous);
+
+    for(uintmax_t y = 0; y < box._height; y++) {
+        uintmax_t x = 0;
+        uintmax_t x_end = box._width;
+
+        if(dirty != nullptr) {
+            const uintmax_t next = dirty->nextDirty(origin._y + y);
+
+            if(next >= origin._y + box._height) {
+                break;
+            }
+
+            y = next - origin._y;
+
+            const DirtySpan& span = dirty->_spans[next];
+
+            if(span._end <= origin._x) {
+                continue;
+            }
+
+            x = span._begin > origin._x ? span._begin - origin._x : 0;
+            x_end = span._end < origin._x + box._width ? span._end - origin._x : box._width;
+        }
+
+        while(x < x_end) {
+            if(!isCellChanged(params, same_keys, Position::create(x, y))) {
+                x++;
+                continue;
+            }
+
+            const uintmax_t run_start = x;
+            const StyleKey run_style = params._contents.styleKey(Position::create(x, y));
+
+            x++;
+
+            while(x < x_end && isCellChanged(params, same_keys, Position::create(x, y)) &&
+                  params._contents.styleKey(Position::create(x, y)) == run_style) {
+                x++;
+            }
+
+            optStringRepeat(instrs, StringParams{
+                        ._area = {
+                            ._pos = {
+                                ._x = params._pos._x + run_start,
+                                ._y = params._pos._y + y,
+                            },
+                            ._len = x - run_start
+                        },
+                        ._str = params._contents.chars(Position::create(run_start, y), x - run_start, *instrs._arena),
+                        ._style = params._contents.style(Position::create(run_start, y))
+                    });
+        }
+    }
+}
+
+}
+
+}
@@ -1,69 +1,42 @@
 #pragma once
 
 #include "codegen/instruction.hpp"
+#include "codegen/instruction-stream.hpp"
 #include "codegen/optimize/string-repeat.hpp"
 
-#include "util/linked-list.hpp"
-
 namespace Tesix {
 
 namespace Codegen {
 
-static LinkedList<Instruction> expandDrawBuffer(
+static void expandDrawBuffer(
+    InstructionStream& instrs,
     const DrawBufferParams& params
 ) {
-    auto instrs = LinkedList<Instruction>::init();
+    const uintmax_t width = params._contents.box()._width;
 
-    for(uintmax_t y = 0; y < params._contents._ch._area._box._height; y++) {
-        uint64_t cur_style = params._contents._style.at(Position::create(0, y)).value();
+    for(uintmax_t y = 0; y < params._contents.box()._height; y++) {
+        uintmax_t x = 0;
 
-        uintmax_t cur_str_start = 0;
+        while(x < width) {
+            const Position start = Position::create(x, y);
 
-        for(uintmax_t x = 1; x < params._contents._ch._area._box._width; x++) {
-            const uint64_t ch_style = params._contents._style.at(Position::create(x, y)).value();
+            const uintmax_t run = params._contents.styleRun(start, width - x);
 
-            if(ch_style != cur_style) {
-                instrs.append(Instruction::createString(StringParams{
-                            ._area = {
-                                ._pos = {
-                                    ._x = params._pos._x + cur_str_start,
-                                    ._y = params._pos._y + y,
-                                },
-                                ._len = x - cur_str_start
+            optStringRepeat(instrs, StringParams{
+                        ._area = {
+                            ._pos = {
+                                ._x = params._pos._x + x,
+                                ._y = params._pos._y + y,
                             },
-                            ._str = &params._contents._ch.at(Position::create(cur_str_start, y)),
-                            ._style = params._contents._style.at(Position::create(cur_str_start, y))
-                        }));
-
-                cur_str_start = x;
-                cur_style = ch_style;
-            }
-        }
-
-        instrs.append(Instruction::createString(StringParams{
-                    ._area = {
-                        ._pos = {
-                            ._x = params._pos._x + cur_str_start,
-                            ._y = params._pos._y + y,
+                            ._len = run
                         },
-                        ._len = params._contents._ch._area._box._width - cur_str_start
-                    },
-                    ._str = &params._contents._ch.at(Position::create(cur_str_start, y)),
-                    ._style = params._contents._style.at(Position::create(cur_str_start, y))
-                }));
-    }
+                        ._str = params._contents.chars(start, run, *instrs._arena),
+                        ._style = params._contents.style(start)
+                    });
 
-    const Node<Instruction>* cur = instrs._front;
-
-    while(cur != nullptr) {
-        const Node<Instruction>* const next = cur->_next;
-
-        instrs.replaceNode(cur, optStringRepeat(cur->_value._value.String));
-
-        cur = next;
+            x += run;
+        }
     }
-
-    return instrs;
 }
 
 }
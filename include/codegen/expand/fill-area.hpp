@@ -1,17 +1,17 @@
 #pragma once
 
 #include "codegen/instruction.hpp"
-
-#include "util/linked-list.hpp"
+#include "codegen/instruction-stream.hpp"
 
 namespace Tesix {
 
 namespace Codegen {
 
-static LinkedList<Instruction> expandFillArea(
+static void expandFillArea(
+    InstructionStream& instrs,
     const FillAreaParams& params
 ) {
-    auto instrs = LinkedList<Instruction>::init();
+    instrs.reserve(instrs._n + params._area._box._height);
 
     for(uintmax_t i = 0; i < params._area._box._height; i++) {
         instrs.append(Instruction::createRepeat(RepeatParams{
@@ -27,8 +27,6 @@ static LinkedList<Instruction> expandFillArea(
                 }
         ));
     }
-
-    return instrs;
 }
 
 }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "codegen/instruction.hpp"
+
+#include "util/arena.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace Tesix {
+
+namespace Codegen {
+
+/**
+ * @brief contiguous list of instructions allocated from an arena
+ * growing leaves the old storage in the arena until it is reset, so the stream must not outlive the arena's reset()
+ **/
+struct InstructionStream {
+    Instruction* _ptr;
+    uintmax_t _cap;
+    uintmax_t _n;
+
+    Arena* _arena;
+
+    static inline InstructionStream init(
+        Arena& arena
+    ) {
+        return {._ptr = nullptr, ._cap = 0, ._n = 0, ._arena = &arena};
+    }
+
+    inline void reserve(
+        const uintmax_t cap
+    ) {
+        if(cap <= _cap) {
+            return;
+        }
+
+        Instruction* const ptr = _arena->push<Instruction>(cap);
+
+        if(_n > 0) {
+            memcpy(static_cast<void*>(ptr), _ptr, _n * sizeof(Instruction));
+        }
+
+        _ptr = ptr;
+        _cap = cap;
+    }
+
+    inline void append(
+        const Instruction& instr
+    ) {
+        if(_n == _cap) {
+            reserve(_cap > 0 ? _cap * 2 : 64);
+        }
+
+        _ptr[_n] = instr;
+        _n += 1;
+    }
+};
+
+}
+
+}
@@ -14,6 +14,7 @@ enum class InstructionE {
 
     FillArea,
     DrawBuffer,
+    DiffBuffer,
 
     EraseDisplay,
     EraseDisplayForwards,
@@ -25,6 +26,8 @@ enum class InstructionE {
     Erase,
 
     RestoreArea,
+
+    Scroll,
 };
 
 struct StringParams {
@@ -50,6 +53,15 @@ struct DrawBufferParams {
     StyledBufferArea _contents;
 };
 
+struct DiffBufferParams {
+    Position _pos;
+    StyledBufferArea _contents;
+    StyledBufferArea _previous;
+
+    // rows of _contents' parent written since it matched _previous, nullptr compares every row
+    const DirtyRows* _dirty;
+};
+
 struct EraseDisplayParams {
     Style::StyleContainer _style;
 };
@@ -94,11 +106,20 @@ struct RestoreAreaParams {
     FloatingBox _area;
 };
 
+// rows _top to _bottom (both included) move _n rows up or down, the rows they leave are blanked in the default style
+struct ScrollParams {
+    uintmax_t _top;
+    uintmax_t _bottom;
+    uintmax_t _n;
+    bool _up;
+};
+
 union InstructionU {
     StringParams String;
     RepeatParams Repeat;
     FillAreaParams FillArea;
     DrawBufferParams DrawBuffer;
+    DiffBufferParams DiffBuffer;
     EraseDisplayParams EraseDisplay;
     EraseDisplayForwardsParams EraseDisplayForwards;
     EraseDisplayBackwardsParams EraseDisplayBackwards;
@@ -109,6 +130,7 @@ union InstructionU {
     EraseParams Erase;
     EraseAreaParams EraseArea;
     RestoreAreaParams RestoreArea;
+    ScrollParams Scroll;
 };
 
 struct Instruction {
@@ -186,6 +208,18 @@ struct Instruction {
     ) {
         return {._type = InstructionE::DrawBuffer, ._value = {.DrawBuffer = params}};
     }
+
+    static inline Instruction createDiffBuffer(
+        const DiffBufferParams& params
+    ) {
+        return {._type = InstructionE::DiffBuffer, ._value = {.DiffBuffer = params}};
+    }
+
+    static inline Instruction createScroll(
+        const ScrollParams& params
+    ) {
+        return {._type = InstructionE::Scroll, ._value = {.Scroll = params}};
+    }
 };
 
 }
@@ -1,63 +1,54 @@
 #pragma once
 
 #include "codegen/instruction.hpp"
+#include "codegen/instruction-stream.hpp"
 
-#include "util/linked-list.hpp"
+#include "output/control-sequences/count.hpp"
+
+#include "util/run.hpp"
+#include "util/utf.hpp"
 
 namespace Tesix {
 
 namespace Codegen {
 
-static LinkedList<Instruction> optStringRepeat(
-    const StringParams& params
+/**
+ * @brief true if writing ch once and repeating it with REP is shorter than writing run copies of it
+ * the character is written in both cases, so only the remaining run - 1 copies are weighed against CSI n b
+ **/
+static inline bool isRepeatCheaper(
+    const uint32_t ch,
+    const uintmax_t run
 ) {
-    auto instrs = LinkedList<Instruction>::init();
+    return Out::Ctrl::countOneParameterEsc(run - 1) < (run - 1) * UTF32::countUTF8Single(ch);
+}
 
+static void optStringRepeat(
+    InstructionStream& instrs,
+    const StringParams& params
+) {
     assert(params._area._len > 0);
 
+    const uintmax_t len = params._area._len;
+
     uintmax_t str_start = 0;
-    uintmax_t rep_start = 0;
-    uint32_t rep_ch = params._str[0];
-    uintmax_t run = 1;
-
-    for(uintmax_t i = 1; i < params._area._len; i++) {
-        const uint32_t ch = params._str[i];
-
-        if(rep_ch != ch) {
-            if(run > 5) {
-                if(str_start != rep_start) {
-                    instrs.append(Instruction::createString({
-                                ._area = {
-                                    ._pos = params._area._pos + Position::create(str_start, 0),
-                                    ._len = rep_start - str_start
-                                },
-                                ._str = params._str + str_start,
-                                ._style = params._style
-                            }));
-                }
-
-                str_start = i;
-
-                instrs.append(Instruction::createRepeat({
-                            ._area = {
-                                ._pos = params._area._pos + Position::create(rep_start, 0),
-                                ._len = run
-                            },
-                            ._ch = rep_ch,
-                            ._style = params._style
-                        }));
-
-            }
-
-            run = 1;
-            rep_ch = ch;
-            rep_start = i;
-        } else {
-            run++;
+    uintmax_t i = 0;
+
+    while(i < len) {
+        const uintmax_t rep_start = i + findRepeat(params._str + i, len - i);
+
+        if(rep_start == len) {
+            break;
+        }
+
+        const uintmax_t run = runLength(params._str + rep_start, len - rep_start);
+
+        i = rep_start + run;
+
+        if(!isRepeatCheaper(params._str[rep_start], run)) {
+            continue;
         }
-    }
 
-    if(run > 5) {
         if(str_start != rep_start) {
             instrs.append(Instruction::createString({
                         ._area = {
@@ -74,21 +65,23 @@ static LinkedList<Instruction> optStringRepeat(
                         ._pos = params._area._pos + Position::create(rep_start, 0),
                         ._len = run
                     },
-                    ._ch = rep_ch,
+                    ._ch = params._str[rep_start],
                     ._style = params._style
                 }));
-    } else {
+
+        str_start = i;
+    }
+
+    if(str_start != len) {
         instrs.append(Instruction::createString({
                     ._area = {
                         ._pos = params._area._pos + Position::create(str_start, 0),
-                        ._len = params._area._len - str_start
+                        ._len = len - str_start
                     },
                     ._str = params._str + str_start,
                     ._style = params._style
                 }));
     }
-
-    return instrs;
 }
 
 }
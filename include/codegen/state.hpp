@@ -1,5 +1,7 @@
 #pragma once
 
+#include "util/arena.hpp"
+#include "util/buffer.hpp"
 #include "util/space.hpp"
 
 #include <stdint.h>
@@ -8,11 +10,30 @@ namespace Tesix {
 
 namespace Codegen {
 
+// _cursor_pos when the terminal's cursor position is not known, the next move is absolute
+constexpr Position CURSOR_UNKNOWN = {._x = UINTMAX_MAX, ._y = UINTMAX_MAX};
+
+// _last_ch when the last character is not known, not a codepoint so REP is never used on it
+constexpr uint32_t CHARACTER_UNKNOWN = UINT32_MAX;
+
 struct State {
+    // Style::STYLE_UNKNOWN if the terminal's style is not known
     uint64_t _style;
     uint32_t _last_ch;
     Position _cursor_pos;
 
+    // terminal width, 0 if unknown, present() sets it to the width of the screen
+    // at _columns the cursor waits for a wrap and its column can not be relied on
+    uintmax_t _columns;
+
+    // cells the terminal shows at _known_pos, the cursor planner may rewrite them instead of moving over them
+    // only valid during a single submitInstruction() that writes cells in row major order
+    const StyledBufferArea* _known;
+    Position _known_pos;
+
+    // scratch memory for instruction expansion, only valid during a single submitInstruction()
+    Arena _scratch;
+
     static inline State initial() {
         return {
             ._style = 0,
@@ -20,9 +41,20 @@ struct State {
             ._cursor_pos = {
                 ._x = 0,
                 ._y = 0
-            }
+            },
+            ._columns = 0,
+            ._known = nullptr,
+            ._known_pos = {
+                ._x = 0,
+                ._y = 0
+            },
+            ._scratch = Arena::init()
         };
     }
+
+    inline void free() {
+        _scratch.free();
+    }
 };
 
 }
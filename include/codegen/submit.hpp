@@ -2,15 +2,16 @@
 
 #include "codegen/state.hpp"
 #include "codegen/instruction.hpp"
+#include "codegen/instruction-stream.hpp"
 
 #include "codegen/submit/common.hpp"
 
 #include "codegen/expand/draw-buffer.hpp"
+#include "codegen/expand/diff-buffer.hpp"
 #include "codegen/expand/fill-area.hpp"
 
 #include "output/instruction.hpp"
 
-#include "util/linked-list.hpp"
 #include "util/array.hpp"
 
 #include <stdint.h>
@@ -19,7 +20,7 @@ namespace Tesix {
 
 namespace Codegen {
 
-static void submitInstruction(
+static Out::FlushStatus submitInstruction(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
@@ -27,15 +28,15 @@ static void submitInstruction(
     const uintmax_t fd
 );
 
-static void submitInstructions(
+static Out::FlushStatus submitInstructions(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
-    const LinkedList<Instruction>& instrs,
+    const InstructionStream& instrs,
     const uintmax_t fd
 );
 
-static void submitString(
+static Out::FlushStatus submitString(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
@@ -43,21 +44,23 @@ static void submitString(
     const uintmax_t fd
 ) {
     if(params._area._len == 0) {
-        return;
+        return Out::FlushStatus::Done;
     }
 
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
-    submitCursorPosition(out_buf, instr_buf, state, params._area._pos, fd);
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    status = Out::mergeFlushStatus(status, submitCursorPosition(out_buf, instr_buf, state, params._area._pos, fd));
 
     const Out::Instruction out_instr = Out::Instruction::createString(Array<uint32_t>::fromRawFull(params._str, params._area._len));
 
-    Out::streamInstruction(out_buf, instr_buf, out_instr, fd);
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, out_instr, fd));
 
     state._cursor_pos._x += params._area._len;
     state._last_ch = params._str[params._area._len - 1];
+
+    return status;
 }
 
-static void submitRepeat(
+static Out::FlushStatus submitRepeat(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
@@ -65,145 +68,231 @@ static void submitRepeat(
     const uintmax_t fd
 ) {
     if(params._area._len == 0) {
-        return;
+        return Out::FlushStatus::Done;
     }
 
-    submitCursorPosition(out_buf, instr_buf, state, params._area._pos, fd);
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    Out::FlushStatus status = submitCursorPosition(out_buf, instr_buf, state, params._area._pos, fd);
+    status = Out::mergeFlushStatus(status, submitStyle(out_buf, instr_buf, state, params._style.value(), fd));
 
     if(params._ch == state._last_ch) {
-        Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createRepeat(params._area._len), fd);
+        status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createRepeat(params._area._len), fd));
 
     } else {
-        Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCharacter(params._ch), fd);
+        status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCharacter(params._ch), fd));
 
         if(params._area._len > 1) {
-            Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createRepeat(params._area._len - 1), fd);
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createRepeat(params._area._len - 1), fd));
         }
     }
 
     state._cursor_pos._x += params._area._len;
     state._last_ch = params._ch;
+
+    return status;
 }
 
-static void submitErase(
+static Out::FlushStatus submitErase(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const EraseParams& params,
     const uintmax_t fd
 ) {
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
-    submitCursorPosition(out_buf, instr_buf, state, params._pos, fd);
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    status = Out::mergeFlushStatus(status, submitCursorPosition(out_buf, instr_buf, state, params._pos, fd));
 
-    Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseCharacters(params._n), fd);
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseCharacters(params._n), fd));
+
+    return status;
 }
 
-static void submitEraseDisplay(
+static Out::FlushStatus submitEraseDisplay(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const EraseDisplayParams& params,
     const uintmax_t fd
 ) {
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseDisplay(), fd));
 
-    Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseDisplay(), fd);
+    return status;
 }
 
-static void submitEraseDisplayForwards(
+static Out::FlushStatus submitEraseDisplayForwards(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const EraseDisplayForwardsParams& params,
     const uintmax_t fd
 ) {
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
-    submitCursorPosition(out_buf, instr_buf, state, params._pos, fd);
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    status = Out::mergeFlushStatus(status, submitCursorPosition(out_buf, instr_buf, state, params._pos, fd));
 
-    Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseDisplayForwards(), fd);
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseDisplayForwards(), fd));
+
+    return status;
 }
 
-static void submitEraseDisplayBackwards(
+static Out::FlushStatus submitEraseDisplayBackwards(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const EraseDisplayBackwardsParams& params,
     const uintmax_t fd
 ) {
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
-    submitCursorPosition(out_buf, instr_buf, state, params._pos, fd);
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    status = Out::mergeFlushStatus(status, submitCursorPosition(out_buf, instr_buf, state, params._pos, fd));
+
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseDisplayBackwards(), fd));
 
-    Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseDisplayBackwards(), fd);
+    return status;
 }
-static void submitEraseLine(
+static Out::FlushStatus submitEraseLine(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const EraseLineParams& params,
     const uintmax_t fd
 ) {
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
-    submitCursorPosition(out_buf, instr_buf, state, {._x = state._cursor_pos._x, ._y = params._y}, fd);
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    status = Out::mergeFlushStatus(status, submitCursorPosition(out_buf, instr_buf, state, {._x = state._cursor_pos._x, ._y = params._y}, fd));
 
-    Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseLine(), fd);
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseLine(), fd));
+
+    return status;
 }
 
-static void submitEraseLineForwards(
+static Out::FlushStatus submitEraseLineForwards(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const EraseLineForwardsParams& params,
     const uintmax_t fd
 ) {
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
-    submitCursorPosition(out_buf, instr_buf, state, params._pos, fd);
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    status = Out::mergeFlushStatus(status, submitCursorPosition(out_buf, instr_buf, state, params._pos, fd));
+
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseLineForwards(), fd));
 
-    Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseLineForwards(), fd);
+    return status;
 }
 
-static void submitEraseLineBackwards(
+static Out::FlushStatus submitEraseLineBackwards(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const EraseLineBackwardsParams& params,
     const uintmax_t fd
 ) {
-    submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
-    submitCursorPosition(out_buf, instr_buf, state, params._pos, fd);
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, params._style.value(), fd);
+    status = Out::mergeFlushStatus(status, submitCursorPosition(out_buf, instr_buf, state, params._pos, fd));
 
-    Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseLineBackwards(), fd);
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createEraseLineBackwards(), fd));
+
+    return status;
 }
 
-static void submitFillArea(
+static Out::FlushStatus submitFillArea(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const FillAreaParams& params,
     const uintmax_t fd
 ) {
-    auto instrs = expandFillArea(params);
+    auto instrs = InstructionStream::init(state._scratch);
+
+    expandFillArea(instrs, params);
+
+    Out::FlushStatus status = submitInstructions(out_buf, instr_buf, state, instrs, fd);
+
+    // queued String instructions may point into the scratch arena
+    status = Out::mergeFlushStatus(status, Out::emptyInstructionBuffer(out_buf, instr_buf, fd));
 
-    submitInstructions(out_buf, instr_buf, state, instrs, fd);
+    state._scratch.reset();
 
-    instrs.free();
+    return status;
 }
 
-static void submitDrawBuffer(
+static Out::FlushStatus submitDrawBuffer(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
     const DrawBufferParams& params,
     const uintmax_t fd
 ) {
-    auto instrs = expandDrawBuffer(params);
+    auto instrs = InstructionStream::init(state._scratch);
+
+    expandDrawBuffer(instrs, params);
+
+    Out::FlushStatus status = submitInstructions(out_buf, instr_buf, state, instrs, fd);
+
+    // queued String instructions may point into the scratch arena
+    status = Out::mergeFlushStatus(status, Out::emptyInstructionBuffer(out_buf, instr_buf, fd));
+
+    state._scratch.reset();
+
+    return status;
+}
+
+static Out::FlushStatus submitDiffBuffer(
+    Array<uint8_t>& out_buf,
+    Array<Out::Instruction>& instr_buf,
+    State& state,
+    const DiffBufferParams& params,
+    const uintmax_t fd
+) {
+    auto instrs = InstructionStream::init(state._scratch);
+
+    expandDiffBuffer(instrs, params);
+
+    // cells the diff skips still show _previous, so the cursor planner may rewrite them
+    state._known = &params._previous;
+    state._known_pos = params._pos;
+
+    Out::FlushStatus status = submitInstructions(out_buf, instr_buf, state, instrs, fd);
+
+    state._known = nullptr;
+
+    // queued String instructions may point into the scratch arena
+    status = Out::mergeFlushStatus(status, Out::emptyInstructionBuffer(out_buf, instr_buf, fd));
 
-    submitInstructions(out_buf, instr_buf, state, instrs, fd);
+    state._scratch.reset();
 
-    instrs.free();
+    return status;
 }
 
-static void submitInstruction(
+static Out::FlushStatus submitScroll(
+    Array<uint8_t>& out_buf,
+    Array<Out::Instruction>& instr_buf,
+    State& state,
+    const ScrollParams& params,
+    const uintmax_t fd
+) {
+    assert(params._top < params._bottom);
+    assert(params._n > 0 && params._n <= params._bottom - params._top);
+
+    // terminals blank the rows scrolled in with the current background
+    Out::FlushStatus status = submitStyle(out_buf, instr_buf, state, 0, fd);
+
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createSetScrollRegion({._top = params._top + 1, ._bottom = params._bottom + 1}), fd));
+
+    if(params._up) {
+        status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createScrollUp(params._n), fd));
+    } else {
+        status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createScrollDown(params._n), fd));
+    }
+
+    status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createResetScrollRegion(), fd));
+
+    // DECSTBM homes the cursor on most terminals, but not with origin mode or on all of them
+    state._cursor_pos = CURSOR_UNKNOWN;
+
+    return status;
+}
+
+static Out::FlushStatus submitInstruction(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
@@ -212,44 +301,51 @@ static void submitInstruction(
 ) {
     switch(instr._type) {
         case InstructionE::String: {
-            submitString(out_buf, instr_buf, state, instr._value.String, fd);
-        } break;
+            return submitString(out_buf, instr_buf, state, instr._value.String, fd);
+        }
         case InstructionE::Repeat: {
-            submitRepeat(out_buf, instr_buf, state, instr._value.Repeat, fd);
-        } break;
+            return submitRepeat(out_buf, instr_buf, state, instr._value.Repeat, fd);
+        }
         case InstructionE::EraseDisplay: {
-            submitEraseDisplay(out_buf, instr_buf, state, instr._value.EraseDisplay, fd);
-        } break;
+            return submitEraseDisplay(out_buf, instr_buf, state, instr._value.EraseDisplay, fd);
+        }
         case InstructionE::EraseDisplayForwards: {
-            submitEraseDisplayForwards(out_buf, instr_buf, state, instr._value.EraseDisplayForwards, fd);
-        } break;
+            return submitEraseDisplayForwards(out_buf, instr_buf, state, instr._value.EraseDisplayForwards, fd);
+        }
         case InstructionE::EraseDisplayBackwards: {
-            submitEraseDisplayBackwards(out_buf, instr_buf, state, instr._value.EraseDisplayBackwards, fd);
-        } break;
+            return submitEraseDisplayBackwards(out_buf, instr_buf, state, instr._value.EraseDisplayBackwards, fd);
+        }
         case InstructionE::FillArea: {
-            submitFillArea(out_buf, instr_buf, state, instr._value.FillArea, fd);
-        } break;
+            return submitFillArea(out_buf, instr_buf, state, instr._value.FillArea, fd);
+        }
         case InstructionE::DrawBuffer: {
-            submitDrawBuffer(out_buf, instr_buf, state, instr._value.DrawBuffer, fd);
-        } break;
-
+            return submitDrawBuffer(out_buf, instr_buf, state, instr._value.DrawBuffer, fd);
+        }
+        case InstructionE::DiffBuffer: {
+            return submitDiffBuffer(out_buf, instr_buf, state, instr._value.DiffBuffer, fd);
+        }
+        case InstructionE::Scroll: {
+            return submitScroll(out_buf, instr_buf, state, instr._value.Scroll, fd);
+        }
     }
+
+    return Out::FlushStatus::Done;
 }
 
-static void submitInstructions(
+static Out::FlushStatus submitInstructions(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
-    const LinkedList<Instruction>& instrs,
+    const InstructionStream& instrs,
     const uintmax_t fd
 ) {
-    Node<Instruction>* cur = instrs._front;
-
-    while(cur != nullptr) {
-        submitInstruction(out_buf, instr_buf, state, cur->_value, fd);
+    Out::FlushStatus status = Out::FlushStatus::Done;
 
-        cur = cur->_next;
+    for(uintmax_t i = 0; i < instrs._n; i++) {
+        status = Out::mergeFlushStatus(status, submitInstruction(out_buf, instr_buf, state, instrs._ptr[i], fd));
     }
+
+    return status;
 }
 
 
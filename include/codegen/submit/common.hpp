@@ -6,6 +6,7 @@
 #include "output/instruction.hpp"
 
 #include "util/array.hpp"
+#include "util/write.hpp"
 
 #include <stdint.h>
 
@@ -15,7 +16,178 @@ namespace Tesix {
 
 namespace Codegen {
 
-static void submitCursorPosition(
+// moves that bring the cursor onto the target line
+enum class LineMoveE {
+    None,
+    LineAbsolute,
+    Up,
+    Down,
+    PrecedingLine,
+    NextLine,
+    CarriageReturnLinefeed,
+};
+
+// moves that bring the cursor onto the target column once it is on the target line
+enum class ColumnMoveE {
+    None,
+    CharacterAbsolute,
+    Forwards,
+    Backwards,
+    CarriageReturn,
+    Reemit,
+};
+
+struct CursorPlan {
+    LineMoveE _line;
+    ColumnMoveE _column;
+
+    // CursorPositionAbsolute when both moves are None
+    bool _absolute;
+
+    uintmax_t _cost;
+};
+
+static inline uintmax_t countCursorEsc(
+    const uintmax_t n
+) {
+    return countDigits(n) + 3;
+}
+
+/**
+ * @brief true if the cells between from and to on line y are known, single width and drawn in the current style
+ **/
+static bool canReemit(
+    const State& state,
+    const uintmax_t y,
+    const uintmax_t from,
+    const uintmax_t to
+) {
+    if(state._known == nullptr) {
+        return false;
+    }
+
+    const Position& origin = state._known_pos;
+    const Box& box = state._known->box();
+
+    if(y < origin._y || y >= origin._y + box._height || from < origin._x || to > origin._x + box._width) {
+        return false;
+    }
+
+    for(uintmax_t x = from; x < to; x++) {
+        const Position pos = Position::create(x - origin._x, y - origin._y);
+
+        const uint32_t ch = state._known->ch(pos);
+
+        if(ch < 0x20 || ch > 0x7e) {
+            return false;
+        }
+
+        if(state._known->styleValue(pos) != state._style) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static inline void considerCursorPlan(
+    CursorPlan& best,
+    const LineMoveE line,
+    const ColumnMoveE column,
+    const uintmax_t cost
+) {
+    if(cost < best._cost) {
+        best = {._line = line, ._column = column, ._absolute = false, ._cost = cost};
+    }
+}
+
+/**
+ * @brief picks the cheapest way to move the cursor from column col on the target line to target._x
+ **/
+static void planColumnMove(
+    CursorPlan& best,
+    const State& state,
+    const LineMoveE line,
+    const uintmax_t line_cost,
+    const uintmax_t col,
+    const bool col_known,
+    const Position& target
+) {
+    if(col_known && col == target._x) {
+        considerCursorPlan(best, line, ColumnMoveE::None, line_cost);
+        return;
+    }
+
+    if(target._x == 0) {
+        considerCursorPlan(best, line, ColumnMoveE::CarriageReturn, line_cost + 1);
+        return;
+    }
+
+    considerCursorPlan(best, line, ColumnMoveE::CharacterAbsolute, line_cost + countCursorEsc(target._x + 1));
+
+    if(!col_known) {
+        return;
+    }
+
+    if(target._x > col) {
+        const uintmax_t dist = target._x - col;
+
+        considerCursorPlan(best, line, ColumnMoveE::Forwards, line_cost + countCursorEsc(dist));
+
+        if(line_cost + dist < best._cost && canReemit(state, target._y, col, target._x)) {
+            considerCursorPlan(best, line, ColumnMoveE::Reemit, line_cost + dist);
+        }
+    } else {
+        considerCursorPlan(best, line, ColumnMoveE::Backwards, line_cost + countCursorEsc(col - target._x));
+    }
+}
+
+static CursorPlan planCursorPosition(
+    const State& state,
+    const Position& target
+) {
+    const Position& cur = state._cursor_pos;
+
+    CursorPlan best = {
+        ._line = LineMoveE::None,
+        ._column = ColumnMoveE::None,
+        ._absolute = true,
+        ._cost = countDigits(target._y + 1) + countDigits(target._x + 1) + 4
+    };
+
+    if(cur == CURSOR_UNKNOWN) {
+        return best;
+    }
+
+    const bool col_known = state._columns == 0 || cur._x < state._columns;
+
+    if(target._y == cur._y) {
+        planColumnMove(best, state, LineMoveE::None, 0, cur._x, col_known, target);
+        return best;
+    }
+
+    const bool down = target._y > cur._y;
+    const uintmax_t dist = down ? target._y - cur._y : cur._y - target._y;
+
+    if(col_known) {
+        planColumnMove(best, state, LineMoveE::LineAbsolute, countCursorEsc(target._y + 1), cur._x, true, target);
+        planColumnMove(best, state, down ? LineMoveE::Down : LineMoveE::Up, countCursorEsc(dist), cur._x, true, target);
+    }
+
+    if(down && dist == 1) {
+        planColumnMove(best, state, LineMoveE::CarriageReturnLinefeed, 2, 0, true, target);
+    }
+
+    planColumnMove(best, state, down ? LineMoveE::NextLine : LineMoveE::PrecedingLine, countCursorEsc(dist), 0, true, target);
+
+    return best;
+}
+
+/**
+ * @brief moves the cursor to target with the cheapest sequence the cost model finds
+ * target is 0 based, the control sequences are converted to the terminal's 1 based positions
+ **/
+static Out::FlushStatus submitCursorPosition(
     Array<uint8_t>& out_buf,
     Array<Out::Instruction>& instr_buf,
     State& state,
@@ -23,35 +195,84 @@ static void submitCursorPosition(
     const uintmax_t fd
 ) {
     if(target == state._cursor_pos) {
-        return;
+        return Out::FlushStatus::Done;
     }
 
-    if(target._x == 0) {
-        if(target._y < state._cursor_pos._y) {
-            Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorPrecedingLine(state._cursor_pos._y - target._y), fd);
-        } else {
-            Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorNextLine(target._y - state._cursor_pos._y), fd);
-        }
+    const CursorPlan plan = planCursorPosition(state, target);
 
-        goto ret;
-    }
+    const Position& cur = state._cursor_pos;
 
-    if(target._x == state._cursor_pos._x) {
-        Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorLineAbsolute(target._y), fd);
+    if(plan._absolute) {
+        const Out::FlushStatus status = Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorPositionAbsolute({._x = target._x + 1, ._y = target._y + 1}), fd);
 
-        goto ret;
+        state._cursor_pos = target;
+        return status;
     }
 
-    if(target._y == state._cursor_pos._y) {
-        Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorCharacterAbsolute(target._x), fd);
+    Out::FlushStatus status = Out::FlushStatus::Done;
 
-        goto ret;
+    uintmax_t col = cur._x;
+
+    switch(plan._line) {
+        case LineMoveE::None: {
+        } break;
+        case LineMoveE::LineAbsolute: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorLineAbsolute(target._y + 1), fd));
+        } break;
+        case LineMoveE::Up: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorUp(cur._y - target._y), fd));
+        } break;
+        case LineMoveE::Down: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorDown(target._y - cur._y), fd));
+        } break;
+        case LineMoveE::PrecedingLine: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorPrecedingLine(cur._y - target._y), fd));
+
+            col = 0;
+        } break;
+        case LineMoveE::NextLine: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorNextLine(target._y - cur._y), fd));
+
+            col = 0;
+        } break;
+        case LineMoveE::CarriageReturnLinefeed: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCarriageReturn(), fd));
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createLinefeed(), fd));
+
+            col = 0;
+        } break;
     }
 
-    Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorPositionAbsolute(target), fd);
+    switch(plan._column) {
+        case ColumnMoveE::None: {
+        } break;
+        case ColumnMoveE::CharacterAbsolute: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorCharacterAbsolute(target._x + 1), fd));
+        } break;
+        case ColumnMoveE::Forwards: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorForwards(target._x - col), fd));
+        } break;
+        case ColumnMoveE::Backwards: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCursorBackwards(col - target._x), fd));
+        } break;
+        case ColumnMoveE::CarriageReturn: {
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createCarriageReturn(), fd));
+        } break;
+        case ColumnMoveE::Reemit: {
+            const Position from = Position::create(col - state._known_pos._x, target._y - state._known_pos._y);
+
+            const uintmax_t str_len = target._x - col;
+            const uint32_t* const str = state._known->chars(from, str_len, state._scratch);
+
+            status = Out::mergeFlushStatus(status, Out::streamInstruction(out_buf, instr_buf, Out::Instruction::createString(Array<uint32_t>::fromRawFull(str, str_len)), fd));
+
+            state._last_ch = str[str_len - 1];
+        } break;
+    }
 
-ret:
     state._cursor_pos = target;
+
+    return status;
 }
 
 }
@@ -20,6 +20,7 @@ constexpr uint8_t DECRC = '8';
 constexpr uint8_t DECSTBM = 'r';
 
 constexpr uint8_t LF = decodeRowColumn(0, 10);
+constexpr uint8_t CR = decodeRowColumn(0, 13);
 
 constexpr uint8_t ESC = decodeRowColumn(1, 11);
 
@@ -38,6 +39,8 @@ constexpr uint8_t DL = decodeRowColumn(4, 13);
 constexpr uint8_t IL = decodeRowColumn(4, 14);
 
 constexpr uint8_t DCH = decodeRowColumn(5, 0);
+constexpr uint8_t SU = decodeRowColumn(5, 3);
+constexpr uint8_t SD = decodeRowColumn(5, 4);
 constexpr uint8_t ECH = decodeRowColumn(5, 8);
 
 constexpr uint8_t REP = decodeRowColumn(6, 2);
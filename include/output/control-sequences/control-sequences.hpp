@@ -10,6 +10,7 @@ namespace Tesix {
 namespace Ctrl {
 
 enum class ControlSequenceE {
+    CarriageReturn,
     Linefeed,
     ReverseLinefeed,
     Newline,
@@ -35,6 +36,10 @@ enum class ControlSequenceE {
     DeleteLines,
     InsertCharacters,
     InsertLines,
+    ScrollUp,
+    ScrollDown,
+    SetScrollRegion,
+    ResetScrollRegion,
     Repeat,
     BoldOn,
     BoldOff,
@@ -53,8 +58,11 @@ enum class ControlSequenceE {
     ColorForegroundFull,
     ColorBackgroundFull,
     ResetStyle,
+    StyleTransition,
     SetPaletteColor,
     ResetPalette,
+    SynchronizedUpdateBegin,
+    SynchronizedUpdateEnd,
 };
 
 union ControlSequenceU {
@@ -72,6 +80,8 @@ union ControlSequenceU {
     uintmax_t DeleteLines;
     uintmax_t InsertCharacters;
     uintmax_t InsertLines;
+    uintmax_t ScrollUp;
+    uintmax_t ScrollDown;
     uintmax_t Repeat;
     PaletteColor SetPaletteColor;
     uint8_t ColorForeground;
@@ -45,7 +45,7 @@ static constexpr uintmax_t countModifierOff() {
 static inline uintmax_t countFullColor(
     const Color24& color
 ) {
-    return countDigits(color._r) + countDigits(color._g) + countDigits(color._b) + 8;
+    return countDigits(color._r) + countDigits(color._g) + countDigits(color._b) + 10;
 }
 
 }
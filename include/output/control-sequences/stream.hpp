@@ -2,6 +2,7 @@
 
 #include "output/control-sequences/control-characters.hpp"
 #include "output/control-sequences/count.hpp"
+#include "output/control-sequences/style.hpp"
 #include "output/control-sequences/write.hpp"
 #include "output/stream.hpp"
 
@@ -18,532 +19,674 @@ namespace Out {
 
 namespace Ctrl {
 
-static inline void streamCSI(
+static inline FlushStatus streamCSI(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t csi[] = {ESC, '['};
 
-    streamBytes(out_buf, csi, countArrayC(csi), fd);
+    return streamBytes(out_buf, csi, countArrayC(csi), fd);
 }
 
-static inline void streamParameterSeparator(
+static inline FlushStatus streamParameterSeparator(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     return streamByte(out_buf, ';', fd);
 }
 
-static inline void streamLinefeed(
+static inline FlushStatus streamCarriageReturn(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
-    constexpr uint8_t ctrl[] = {ESC, LF};
+    return streamByte(out_buf, CR, fd);
+}
 
-    {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
-    }
+static inline FlushStatus streamLinefeed(
+    Array<uint8_t>& out_buf,
+    const uintmax_t fd
+) {
+    return streamByte(out_buf, LF, fd);
 }
 
-static inline void streamReverseLinefeed(
+static inline FlushStatus streamReverseLinefeed(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, RI};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static inline void streamNewline(
+static inline FlushStatus streamNewline(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
-    streamByte(out_buf, NEL, fd);
+    return streamByte(out_buf, NEL, fd);
 }
 
-static void streamCursorUp(
+static FlushStatus streamCursorUp(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendCursorUp(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, CUU, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, CUU, fd));
     }
+
+    return status;
 }
 
-static void streamCursorDown(
+static FlushStatus streamCursorDown(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendCursorDown(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, CUD, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, CUD, fd));
     }
+
+    return status;
 }
 
-static void streamCursorForwards(
+static FlushStatus streamCursorForwards(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendCursorForwards(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, CUF, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, CUF, fd));
     }
+
+    return status;
 }
 
-static void streamCursorBackwards(
+static FlushStatus streamCursorBackwards(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendCursorBackwards(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, CUB, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, CUB, fd));
     }
+
+    return status;
 }
 
-static void streamCursorPrecedingLine(
+static FlushStatus streamCursorPrecedingLine(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendCursorPrecedingLine(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, CPL, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, CPL, fd));
     }
+
+    return status;
 }
 
-static void streamCursorNextLine(
+static FlushStatus streamCursorNextLine(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendCursorNextLine(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, CNL, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, CNL, fd));
     }
+
+    return status;
 }
 
-static void streamCursorLineAbsolute(
+static FlushStatus streamCursorLineAbsolute(
     Array<uint8_t>& out_buf,
     const uintmax_t line,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(line) <= out_buf.remaining()) {
         appendCursorLineAbsolute(out_buf, line);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, line, fd);
-        streamByte(out_buf, VPA, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, line, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, VPA, fd));
     }
+
+    return status;
 }
 
-static void streamCursorCharacterAbsolute(
+static FlushStatus streamCursorCharacterAbsolute(
     Array<uint8_t>& out_buf,
     const uintmax_t ch,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(ch) <= out_buf.remaining()) {
         appendCursorCharacterAbsolute(out_buf, ch);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, ch, fd);
-        streamByte(out_buf, CHA, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, ch, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, CHA, fd));
     }
+
+    return status;
 }
 
 
-static void streamCursorPositionAbsolute(
+static FlushStatus streamCursorPositionAbsolute(
     Array<uint8_t>& out_buf,
     const Position& pos,
     const uintmax_t fd
 ) {
     if(countTwoParameterEsc(pos._x, pos._y) <= out_buf.remaining()) {
         appendCursorPositionAbsolute(out_buf, pos);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
 
-        streamUInt(out_buf, pos._y, fd);
-        streamParameterSeparator(out_buf, fd);
-        streamUInt(out_buf, pos._x, fd);
+        status = mergeFlushStatus(status, streamUInt(out_buf, pos._y, fd));
+        status = mergeFlushStatus(status, streamParameterSeparator(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, pos._x, fd));
 
-        streamByte(out_buf, CUP, fd);
+        status = mergeFlushStatus(status, streamByte(out_buf, CUP, fd));
     }
+
+    return status;
 }
 
-static inline void streamSaveCursor(
+static inline FlushStatus streamSaveCursor(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', 's'};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static inline void streamRestoreCursor(
+static inline FlushStatus streamRestoreCursor(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', 'u'};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamEraseCharacters(
+static FlushStatus streamEraseCharacters(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendEraseCharacters(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, ECH, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, ECH, fd));
     }
+
+    return status;
 }
 
-static void streamEraseLineForwards(
+static FlushStatus streamEraseLineForwards(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', EL};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamEraseLineBackwards(
+static FlushStatus streamEraseLineBackwards(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '1', EL};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamEraseLine(
+static FlushStatus streamEraseLine(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '2', EL};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamEraseDisplayForwards(
+static FlushStatus streamEraseDisplayForwards(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', ED};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamEraseDisplayBackwards(
+static FlushStatus streamEraseDisplayBackwards(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '1', ED};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamEraseDisplay(
+static FlushStatus streamEraseDisplay(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '2', ED};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamDeleteCharacters(
+static FlushStatus streamDeleteCharacters(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendDeleteCharacters(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, DCH, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, DCH, fd));
     }
+
+    return status;
 }
 
-static void streamDeleteLines(
+static FlushStatus streamDeleteLines(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendDeleteLines(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, DL, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, DL, fd));
     }
+
+    return status;
 }
 
-static void streamInsertCharacters(
+static FlushStatus streamInsertCharacters(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendInsertCharacters(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, ICH, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, ICH, fd));
     }
+
+    return status;
 }
 
-static void streamInsertLines(
+static FlushStatus streamInsertLines(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendInsertLines(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, IL, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, IL, fd));
     }
+
+    return status;
 }
 
-static void streamRepeat(
+static FlushStatus streamScrollUp(
+    Array<uint8_t>& out_buf,
+    const uintmax_t n,
+    const uintmax_t fd
+) {
+    if(countOneParameterEsc(n) <= out_buf.remaining()) {
+        appendScrollUp(out_buf, n);
+        return FlushStatus::Done;
+    }
+
+    FlushStatus status = FlushStatus::Done;
+
+    {
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, SU, fd));
+    }
+
+    return status;
+}
+
+static FlushStatus streamScrollDown(
+    Array<uint8_t>& out_buf,
+    const uintmax_t n,
+    const uintmax_t fd
+) {
+    if(countOneParameterEsc(n) <= out_buf.remaining()) {
+        appendScrollDown(out_buf, n);
+        return FlushStatus::Done;
+    }
+
+    FlushStatus status = FlushStatus::Done;
+
+    {
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, SD, fd));
+    }
+
+    return status;
+}
+
+static FlushStatus streamSetScrollRegion(
+    Array<uint8_t>& out_buf,
+    const uintmax_t top,
+    const uintmax_t bottom,
+    const uintmax_t fd
+) {
+    if(countTwoParameterEsc(top, bottom) <= out_buf.remaining()) {
+        appendSetScrollRegion(out_buf, top, bottom);
+        return FlushStatus::Done;
+    }
+
+    FlushStatus status = FlushStatus::Done;
+
+    {
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+
+        status = mergeFlushStatus(status, streamUInt(out_buf, top, fd));
+        status = mergeFlushStatus(status, streamParameterSeparator(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, bottom, fd));
+
+        status = mergeFlushStatus(status, streamByte(out_buf, DECSTBM, fd));
+    }
+
+    return status;
+}
+
+static FlushStatus streamResetScrollRegion(
+    Array<uint8_t>& out_buf,
+    const uintmax_t fd
+) {
+    constexpr uint8_t ctrl[] = {ESC, '[', DECSTBM};
+
+    {
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+    }
+}
+
+static FlushStatus streamRepeat(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
 ) {
     if(countOneParameterEsc(n) <= out_buf.remaining()) {
         appendRepeat(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamCSI(out_buf, fd);
-        streamUInt(out_buf, n, fd);
-        streamByte(out_buf, REP, fd);
+        status = mergeFlushStatus(status, streamCSI(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, n, fd));
+        status = mergeFlushStatus(status, streamByte(out_buf, REP, fd));
     }
+
+    return status;
 }
 
-static void streamBoldOn(
+static FlushStatus streamBoldOn(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '1', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamBoldOff(
+static FlushStatus streamBoldOff(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '2', '2', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamItalicOn(
+static FlushStatus streamItalicOn(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '3', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamItalicOff(
+static FlushStatus streamItalicOff(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '2', '3', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamUnderlinedOn(
+static FlushStatus streamUnderlinedOn(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '4', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamUnderlinedOff(
+static FlushStatus streamUnderlinedOff(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '2', '4', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamBlinkingOn(
+static FlushStatus streamBlinkingOn(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '5', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamBlinkingOff(
+static FlushStatus streamBlinkingOff(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '2', '5', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamReverseOn(
+static FlushStatus streamReverseOn(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '7', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamReverseOff(
+static FlushStatus streamReverseOff(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '2', '7', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamStrikethroughOn(
+static FlushStatus streamStrikethroughOn(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '9', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamStrikethroughOff(
+static FlushStatus streamStrikethroughOff(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '2', '9', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamColorForeground(
+static FlushStatus streamColorForeground(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
@@ -552,28 +695,32 @@ static void streamColorForeground(
 
     if(countColorForeground() <= out_buf.remaining()) {
         appendColorForeground(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
     constexpr uint8_t style_op_lower[] = {ESC, '[', '3'};
     constexpr uint8_t style_op_upper[] = {ESC, '[', '9'};
 
+    FlushStatus status = FlushStatus::Done;
+
     {
         if(n < 8) {
-            streamBytes(out_buf, style_op_lower, countArrayC(style_op_lower), fd);
+            status = mergeFlushStatus(status, streamBytes(out_buf, style_op_lower, countArrayC(style_op_lower), fd));
 
-            streamByte(out_buf, '0' + n, fd);
+            status = mergeFlushStatus(status, streamByte(out_buf, '0' + n, fd));
         } else {
-            streamBytes(out_buf, style_op_upper, countArrayC(style_op_upper), fd);
+            status = mergeFlushStatus(status, streamBytes(out_buf, style_op_upper, countArrayC(style_op_upper), fd));
 
-            streamByte(out_buf, '0' + (n - 8), fd);
+            status = mergeFlushStatus(status, streamByte(out_buf, '0' + (n - 8), fd));
         }
 
-        streamByte(out_buf, SGR, fd);
+        status = mergeFlushStatus(status, streamByte(out_buf, SGR, fd));
     }
+
+    return status;
 }
 
-static void streamColorBackground(
+static FlushStatus streamColorBackground(
     Array<uint8_t>& out_buf,
     const uintmax_t n,
     const uintmax_t fd
@@ -582,90 +729,115 @@ static void streamColorBackground(
 
     if(countColorBackground(n) <= out_buf.remaining()) {
         appendColorBackground(out_buf, n);
-        return;
+        return FlushStatus::Done;
     }
 
     constexpr uint8_t style_op_lower[] = {ESC, '[', '4'};
     constexpr uint8_t style_op_upper[] = {ESC, '[', '1', '0'};
 
+    FlushStatus status = FlushStatus::Done;
+
     {
         if(n <= 8) {
-            streamBytes(out_buf, style_op_lower, countArrayC(style_op_lower), fd);
+            status = mergeFlushStatus(status, streamBytes(out_buf, style_op_lower, countArrayC(style_op_lower), fd));
 
-            streamByte(out_buf, '0' + n, fd);
+            status = mergeFlushStatus(status, streamByte(out_buf, '0' + n, fd));
         } else {
-            streamBytes(out_buf, style_op_upper, countArrayC(style_op_upper), fd);
+            status = mergeFlushStatus(status, streamBytes(out_buf, style_op_upper, countArrayC(style_op_upper), fd));
 
-            streamByte(out_buf, '0' + (n - 8), fd);
+            status = mergeFlushStatus(status, streamByte(out_buf, '0' + (n - 8), fd));
         }
 
-        streamByte(out_buf, SGR, fd);
+        status = mergeFlushStatus(status, streamByte(out_buf, SGR, fd));
     }
+
+    return status;
 }
 
-static void streamColorForegroundFull(
+static FlushStatus streamColorForegroundFull(
     Array<uint8_t>& out_buf,
     const Color24& color,
     const uintmax_t fd
 ) {
     if(countFullColor(color) <= out_buf.remaining()) {
         appendColorForegroundFull(out_buf, color);
-        return;
+        return FlushStatus::Done;
     }
 
     constexpr uint8_t style_op[] = {ESC, '[', '3', '8', ';', '2', ';'};
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamBytes(out_buf, style_op, countArrayC(style_op), fd);
+        status = mergeFlushStatus(status, streamBytes(out_buf, style_op, countArrayC(style_op), fd));
 
-        streamUInt(out_buf, color._r, fd);
-        streamParameterSeparator(out_buf, fd);
-        streamUInt(out_buf, color._g, fd);
-        streamParameterSeparator(out_buf, fd);
-        streamUInt(out_buf, color._b, fd);
+        status = mergeFlushStatus(status, streamUInt(out_buf, color._r, fd));
+        status = mergeFlushStatus(status, streamParameterSeparator(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, color._g, fd));
+        status = mergeFlushStatus(status, streamParameterSeparator(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, color._b, fd));
 
-        streamByte(out_buf, SGR, fd);
+        status = mergeFlushStatus(status, streamByte(out_buf, SGR, fd));
     }
+
+    return status;
 }
 
-static void streamColorBackgroundFull(
+static FlushStatus streamColorBackgroundFull(
     Array<uint8_t>& out_buf,
     const Color24& color,
     const uintmax_t fd
 ) {
     if(countFullColor(color) <= out_buf.remaining()) {
         appendColorBackgroundFull(out_buf, color);
-        return;
+        return FlushStatus::Done;
     }
 
     constexpr uint8_t style_op[] = {ESC, '[', '4', '8', ';', '2', ';'};
 
+    FlushStatus status = FlushStatus::Done;
+
     {
-        streamBytes(out_buf, style_op, countArrayC(style_op), fd);
+        status = mergeFlushStatus(status, streamBytes(out_buf, style_op, countArrayC(style_op), fd));
 
-        streamUInt(out_buf, color._r, fd);
-        streamParameterSeparator(out_buf, fd);
-        streamUInt(out_buf, color._g, fd);
-        streamParameterSeparator(out_buf, fd);
-        streamUInt(out_buf, color._b, fd);
+        status = mergeFlushStatus(status, streamUInt(out_buf, color._r, fd));
+        status = mergeFlushStatus(status, streamParameterSeparator(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, color._g, fd));
+        status = mergeFlushStatus(status, streamParameterSeparator(out_buf, fd));
+        status = mergeFlushStatus(status, streamUInt(out_buf, color._b, fd));
 
-        streamByte(out_buf, SGR, fd);
+        status = mergeFlushStatus(status, streamByte(out_buf, SGR, fd));
     }
+
+    return status;
 }
 
-static void streamResetStyle(
+static FlushStatus streamResetStyle(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {ESC, '[', '0', SGR};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 
 }
 
-static void streamSetPaletteColor(
+static FlushStatus streamStyleTransition(
+    Array<uint8_t>& out_buf,
+    const uint64_t from,
+    const uint64_t to,
+    const uintmax_t fd
+) {
+    uint8_t ctrl[STYLE_TRANSITION_MAX_C];
+
+    {
+        return streamBytes(out_buf, ctrl, writeStyleTransitionCached(ctrl, from, to) - ctrl, fd);
+    }
+}
+
+static FlushStatus streamSetPaletteColor(
     Array<uint8_t>& out_buf,
     const PaletteColor& color,
     const uintmax_t fd
@@ -680,18 +852,40 @@ static void streamSetPaletteColor(
     }
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+    }
+}
+
+static FlushStatus streamSynchronizedUpdateBegin(
+    Array<uint8_t>& out_buf,
+    const uintmax_t fd
+) {
+    constexpr uint8_t ctrl[] = {ESC, '[', '?', '2', '0', '2', '6', 'h'};
+
+    {
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+    }
+}
+
+static FlushStatus streamSynchronizedUpdateEnd(
+    Array<uint8_t>& out_buf,
+    const uintmax_t fd
+) {
+    constexpr uint8_t ctrl[] = {ESC, '[', '?', '2', '0', '2', '6', 'l'};
+
+    {
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
-static void streamResetPalette(
+static FlushStatus streamResetPalette(
     Array<uint8_t>& out_buf,
     const uintmax_t fd
 ) {
     constexpr uint8_t ctrl[] = {OSC, 'R'};
 
     {
-        streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
+        return streamBytes(out_buf, ctrl, countArrayC(ctrl), fd);
     }
 }
 
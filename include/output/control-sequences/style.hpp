@@ -0,0 +1,333 @@
+#pragma once
+
+#include "output/control-sequences/control-characters.hpp"
+
+#include "util/color.hpp"
+#include "util/style.hpp"
+#include "util/write.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace Tesix {
+
+namespace Out {
+
+namespace Ctrl {
+
+// worst case size of a single style transition, reset plus every attribute at its longest
+constexpr uintmax_t STYLE_TRANSITION_MAX_C = 64;
+
+static inline uint8_t* writeSGRParameter(
+    uint8_t* dest,
+    const uint8_t n
+) {
+    dest = writeUInt(dest, n);
+    *dest = ';';
+
+    return dest + 1;
+}
+
+static uint8_t* writeSGRColor24(
+    uint8_t* dest,
+    const uint8_t mode,
+    const Color24& color
+) {
+    dest = writeSGRParameter(dest, mode);
+    dest = writeSGRParameter(dest, 2);
+    dest = writeSGRParameter(dest, color._r);
+    dest = writeSGRParameter(dest, color._g);
+    dest = writeSGRParameter(dest, color._b);
+
+    return dest;
+}
+
+static uint8_t* writeSGRForeground(
+    uint8_t* dest,
+    const Style::FCFMFg& fg
+) {
+    switch(fg._tag) {
+        case Style::ColorMode::Default: {
+            return writeSGRParameter(dest, 39);
+        } break;
+        case Style::ColorMode::Palette: {
+            return writeSGRParameter(dest, fg._value.P < 8 ? 30 + fg._value.P : 90 + (fg._value.P - 8));
+        } break;
+        case Style::ColorMode::FullColor: {
+            return writeSGRColor24(dest, 38, fg._value.FC);
+        } break;
+    }
+
+    return dest;
+}
+
+static uint8_t* writeSGRBackground(
+    uint8_t* dest,
+    const Style::FCFMBg& bg
+) {
+    switch(bg._tag) {
+        case Style::ColorMode::Default: {
+            return writeSGRParameter(dest, 49);
+        } break;
+        case Style::ColorMode::Palette: {
+            return writeSGRParameter(dest, bg._value.P < 8 ? 40 + bg._value.P : 100 + (bg._value.P - 8));
+        } break;
+        case Style::ColorMode::FullColor: {
+            return writeSGRColor24(dest, 48, bg._value.FC.truncate());
+        } break;
+    }
+
+    return dest;
+}
+
+static inline bool isSameForeground(
+    const Style::FCFMFg& a,
+    const Style::FCFMFg& b
+) {
+    if(a._tag != b._tag) {
+        return false;
+    }
+
+    switch(a._tag) {
+        case Style::ColorMode::Default: {
+            return true;
+        } break;
+        case Style::ColorMode::Palette: {
+            return a._value.P == b._value.P;
+        } break;
+        case Style::ColorMode::FullColor: {
+            return a._value.FC == b._value.FC;
+        } break;
+    }
+
+    return false;
+}
+
+// the alpha of a background color only matters for compositing, terminals never see it
+static inline bool isSameBackground(
+    const Style::FCFMBg& a,
+    const Style::FCFMBg& b
+) {
+    if(a._tag != b._tag) {
+        return false;
+    }
+
+    switch(a._tag) {
+        case Style::ColorMode::Default: {
+            return true;
+        } break;
+        case Style::ColorMode::Palette: {
+            return a._value.P == b._value.P;
+        } break;
+        case Style::ColorMode::FullColor: {
+            return a._value.FC.truncate() == b._value.FC.truncate();
+        } break;
+    }
+
+    return false;
+}
+
+static inline uint8_t* writeSGRModifier(
+    uint8_t* dest,
+    const bool target,
+    const bool current,
+    const bool is_reset,
+    const uint8_t on,
+    const uint8_t off
+) {
+    if(is_reset) {
+        return target ? writeSGRParameter(dest, on) : dest;
+    }
+
+    if(target == current) {
+        return dest;
+    }
+
+    return writeSGRParameter(dest, target ? on : off);
+}
+
+/**
+ * @brief writes the ';' terminated SGR parameters that turn current into target
+ * with is_reset the parameters start with a reset and only set what target needs
+ **/
+static uint8_t* writeSGRParametersFCFM(
+    uint8_t* dest,
+    const Style::Style& target,
+    const Style::Style& current,
+    const bool is_reset
+) {
+    const Style::FCFMFg& fg = target._fg.FCFM;
+    const Style::FCFMBg& bg = target._bg.FCFM;
+
+    const Style::FCFMMod& mod = target._mod.FCFM;
+    const Style::FCFMMod& cur_mod = current._mod.FCFM;
+
+    if(is_reset) {
+        dest = writeSGRParameter(dest, 0);
+    }
+
+    if(is_reset ? fg._tag != Style::ColorMode::Default : !isSameForeground(fg, current._fg.FCFM)) {
+        dest = writeSGRForeground(dest, fg);
+    }
+
+    if(is_reset ? bg._tag != Style::ColorMode::Default : !isSameBackground(bg, current._bg.FCFM)) {
+        dest = writeSGRBackground(dest, bg);
+    }
+
+    dest = writeSGRModifier(dest, mod._bold, cur_mod._bold, is_reset, 1, 22);
+    dest = writeSGRModifier(dest, mod._italic, cur_mod._italic, is_reset, 3, 23);
+    dest = writeSGRModifier(dest, mod._underlined, cur_mod._underlined, is_reset, 4, 24);
+    dest = writeSGRModifier(dest, mod._blinking, cur_mod._blinking, is_reset, 5, 25);
+    dest = writeSGRModifier(dest, mod._reverse, cur_mod._reverse, is_reset, 7, 27);
+    dest = writeSGRModifier(dest, mod._strikethrough, cur_mod._strikethrough, is_reset, 9, 29);
+
+    return dest;
+}
+
+/**
+ * @brief writes a single SGR sequence that turns the current style into the target style
+ * both the change from current and a reset followed by target are encoded, the shorter one is kept
+ * writes nothing if the terminal would show both styles the same
+ * current may be Style::STYLE_UNKNOWN, then the sequence always starts with a reset
+ **/
+static uint8_t* writeStyleTransition(
+    uint8_t* dest,
+    const uint64_t current_enc,
+    const uint64_t target_enc
+) {
+    if(current_enc == target_enc) {
+        return dest;
+    }
+
+    // an unknown style can only be left with a reset
+    const bool is_unknown = current_enc == Style::STYLE_UNKNOWN;
+
+    const auto target = Style::Style::fromEncoding(target_enc);
+    const auto current = Style::Style::fromEncoding(is_unknown ? 0 : current_enc);
+
+    uint8_t diff[STYLE_TRANSITION_MAX_C];
+    uint8_t reset[STYLE_TRANSITION_MAX_C];
+
+    uint8_t* diff_end = diff;
+    uint8_t* reset_end = reset;
+
+    switch(current._tag) {
+        case Style::StyleEncoding::FCFM: {
+            switch(target._tag) {
+                case Style::StyleEncoding::FCFM: {
+                    diff_end = writeSGRParametersFCFM(diff, target, current, false);
+                    reset_end = writeSGRParametersFCFM(reset, target, current, true);
+                } break;
+            }
+        } break;
+    }
+
+    const uint8_t* params = diff;
+    uintmax_t params_c = diff_end - diff;
+
+    if(is_unknown || static_cast<uintmax_t>(reset_end - reset) < params_c) {
+        params = reset;
+        params_c = reset_end - reset;
+    }
+
+    if(params_c == 0) {
+        return dest;
+    }
+
+    dest[0] = ESC;
+    dest[1] = '[';
+
+    memcpy(dest + 2, params, params_c);
+
+    // the last parameter's separator becomes the final byte
+    dest[2 + params_c - 1] = SGR;
+
+    return dest + 2 + params_c;
+}
+
+constexpr uintmax_t STYLE_TRANSITION_CACHE_C = 256;
+constexpr uintmax_t STYLE_TRANSITION_CACHE_PROBE_C = 8;
+
+// an entry with _from == _to is empty, equal styles never need a transition
+struct StyleTransitionCacheEntry {
+    uint64_t _from;
+    uint64_t _to;
+
+    uint8_t _n;
+    uint8_t _bytes[STYLE_TRANSITION_MAX_C];
+};
+
+/**
+ * @brief open addressed table of encoded transitions, UIs only use a few dozen styles so most lookups hit
+ * when every probed slot is taken the home slot is overwritten
+ **/
+struct StyleTransitionCache {
+    StyleTransitionCacheEntry _entries[STYLE_TRANSITION_CACHE_C];
+};
+
+static inline StyleTransitionCache& styleTransitionCache() {
+    static thread_local StyleTransitionCache cache = {};
+
+    return cache;
+}
+
+static inline uintmax_t hashStyleTransition(
+    const uint64_t from,
+    const uint64_t to
+) {
+    uint64_t h = from * 0x9e3779b97f4a7c15 ^ (to + 0x632be59bd9b4e019 + (from << 6) + (from >> 2));
+
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93;
+    h ^= h >> 32;
+
+    return h;
+}
+
+/**
+ * @brief same as writeStyleTransition() but repeated transitions are copied from the cache
+ **/
+static uint8_t* writeStyleTransitionCached(
+    uint8_t* dest,
+    const uint64_t from,
+    const uint64_t to
+) {
+    if(from == to) {
+        return dest;
+    }
+
+    StyleTransitionCache& cache = styleTransitionCache();
+
+    const uintmax_t home = hashStyleTransition(from, to) % STYLE_TRANSITION_CACHE_C;
+
+    StyleTransitionCacheEntry* slot = &cache._entries[home];
+
+    for(uintmax_t i = 0; i < STYLE_TRANSITION_CACHE_PROBE_C; i++) {
+        StyleTransitionCacheEntry& entry = cache._entries[(home + i) % STYLE_TRANSITION_CACHE_C];
+
+        if(entry._from == from && entry._to == to) {
+            memcpy(dest, entry._bytes, entry._n);
+
+            return dest + entry._n;
+        }
+
+        if(entry._from == entry._to) {
+            slot = &entry;
+            break;
+        }
+    }
+
+    slot->_from = from;
+    slot->_to = to;
+    slot->_n = writeStyleTransition(slot->_bytes, from, to) - slot->_bytes;
+
+    memcpy(dest, slot->_bytes, slot->_n);
+
+    return dest + slot->_n;
+}
+
+}
+
+}
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "output/control-sequences/control-characters.hpp"
+#include "output/control-sequences/style.hpp"
 #include "output/number.hpp"
 
 #include "util/array.hpp"
@@ -34,14 +35,16 @@ static void appendParameterSeparator(
     dest.append(';');
 }
 
-static void appendLinefeed(
+static void appendCarriageReturn(
     Array<uint8_t>& dest
 ) {
-    constexpr uint8_t esc[] = {ESC, LF};
+    return dest.append(CR);
+}
 
-    {
-        dest.appendMulti(esc, countArrayC(esc));
-    }
+static void appendLinefeed(
+    Array<uint8_t>& dest
+) {
+    return dest.append(LF);
 }
 
 static void appendReverseLinefeed(
@@ -240,7 +243,7 @@ static void appendDeleteCharacters(
 ) {
     appendCSI(dest);
     appendUInt(dest, n);
-    dest.append(DL);
+    dest.append(DCH);
 }
 
 static void appendDeleteLines(
@@ -270,6 +273,48 @@ static void appendInsertLines(
     dest.append(IL);
 }
 
+static void appendScrollUp(
+    Array<uint8_t>& dest,
+    const uintmax_t n
+) {
+    appendCSI(dest);
+    appendUInt(dest, n);
+    dest.append(SU);
+}
+
+static void appendScrollDown(
+    Array<uint8_t>& dest,
+    const uintmax_t n
+) {
+    appendCSI(dest);
+    appendUInt(dest, n);
+    dest.append(SD);
+}
+
+static void appendSetScrollRegion(
+    Array<uint8_t>& dest,
+    const uintmax_t top,
+    const uintmax_t bottom
+) {
+    appendCSI(dest);
+
+    appendUInt(dest, top);
+    appendParameterSeparator(dest);
+    appendUInt(dest, bottom);
+
+    dest.append(DECSTBM);
+}
+
+static void appendResetScrollRegion(
+    Array<uint8_t>& dest
+) {
+    constexpr uint8_t ctrl[] = {ESC, '[', DECSTBM};
+
+    {
+        dest.appendMulti(ctrl, countArrayC(ctrl));
+    }
+}
+
 static void appendRepeat(
     Array<uint8_t>& dest,
     const uintmax_t n
@@ -496,6 +541,18 @@ static void appendResetStyle(
     }
 }
 
+static void appendStyleTransition(
+    Array<uint8_t>& dest,
+    const uint64_t from,
+    const uint64_t to
+) {
+    uint8_t ctrl[STYLE_TRANSITION_MAX_C];
+
+    {
+        dest.appendMulti(ctrl, writeStyleTransitionCached(ctrl, from, to) - ctrl);
+    }
+}
+
 static void appendSetPaletteColor(
     Array<uint8_t>& dest,
     const PaletteColor& color
@@ -514,6 +571,26 @@ static void appendSetPaletteColor(
     }
 }
 
+static void appendSynchronizedUpdateBegin(
+    Array<uint8_t>& dest
+) {
+    constexpr uint8_t ctrl[] = {ESC, '[', '?', '2', '0', '2', '6', 'h'};
+
+    {
+        dest.appendMulti(ctrl, countArrayC(ctrl));
+    }
+}
+
+static void appendSynchronizedUpdateEnd(
+    Array<uint8_t>& dest
+) {
+    constexpr uint8_t ctrl[] = {ESC, '[', '?', '2', '0', '2', '6', 'l'};
+
+    {
+        dest.appendMulti(ctrl, countArrayC(ctrl));
+    }
+}
+
 static void appendResetPalette(
     Array<uint8_t>& dest
 ) {
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Tesix {
+
+namespace Out {
+
+enum class FlushStatus {
+    Done,
+    WouldBlock, // the fd is nonblocking and its queue is full, retry once it is writable again
+    Error,
+};
+
+/**
+ * @brief the status of two writes made one after the other, an error outweighs backpressure, which outweighs success
+ **/
+static inline FlushStatus mergeFlushStatus(
+    const FlushStatus a,
+    const FlushStatus b
+) {
+    return a > b ? a : b;
+}
+
+struct FlushResult {
+    FlushStatus _status;
+    uintmax_t _written;
+};
+
+/**
+ * @brief writes all iovecs, resuming after short writes and interrupts
+ * stops early with FlushStatus::WouldBlock when the fd reports EAGAIN, the iovecs are updated to describe what is left
+ **/
+static FlushResult writeVec(
+    const uintmax_t fd,
+    struct iovec* iov,
+    uintmax_t iov_c
+) {
+    uintmax_t written = 0;
+
+    while(iov_c > 0 && iov[0].iov_len == 0) {
+        iov++;
+        iov_c--;
+    }
+
+    while(iov_c > 0) {
+        const ssize_t ret = writev(fd, iov, iov_c);
+
+        if(ret < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                return {._status = FlushStatus::WouldBlock, ._written = written};
+            }
+
+            return {._status = FlushStatus::Error, ._written = written};
+        }
+
+        written += ret;
+
+        uintmax_t rem = ret;
+
+        while(iov_c > 0 && rem >= iov[0].iov_len) {
+            rem -= iov[0].iov_len;
+            iov[0].iov_len = 0;
+
+            iov++;
+            iov_c--;
+        }
+
+        if(iov_c > 0) {
+            iov[0].iov_base = static_cast<uint8_t*>(iov[0].iov_base) + rem;
+            iov[0].iov_len -= rem;
+        }
+    }
+
+    return {._status = FlushStatus::Done, ._written = written};
+}
+
+static FlushStatus waitWritable(
+    const uintmax_t fd
+) {
+    struct pollfd pfd = {.fd = static_cast<int>(fd), .events = POLLOUT, .revents = 0};
+
+    while(true) {
+        const int ret = poll(&pfd, 1, -1);
+
+        if(ret > 0) {
+            return (pfd.revents & (POLLERR | POLLNVAL)) ? FlushStatus::Error : FlushStatus::Done;
+        }
+
+        if(ret < 0 && errno != EINTR) {
+            return FlushStatus::Error;
+        }
+    }
+}
+
+/**
+ * @brief like writeVec() but waits for a nonblocking fd to become writable instead of giving up
+ **/
+static FlushResult writeVecAll(
+    const uintmax_t fd,
+    struct iovec* iov,
+    uintmax_t iov_c
+) {
+    uintmax_t written = 0;
+
+    while(true) {
+        const FlushResult res = writeVec(fd, iov, iov_c);
+
+        written += res._written;
+
+        if(res._status != FlushStatus::WouldBlock) {
+            return {._status = res._status, ._written = written};
+        }
+
+        if(waitWritable(fd) == FlushStatus::Error) {
+            return {._status = FlushStatus::Error, ._written = written};
+        }
+    }
+}
+
+}
+
+}
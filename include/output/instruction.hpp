@@ -1,6 +1,7 @@
 #pragma once
 
 #include "output/control-sequences/stream.hpp"
+#include "output/control-sequences/style.hpp"
 #include "output/control-sequences/write.hpp"
 
 #include "util/array.hpp"
@@ -18,6 +19,7 @@ namespace Out {
 enum class InstructionE {
     Character,
     String,
+    CarriageReturn,
     Linefeed,
     ReverseLinefeed,
     Newline,
@@ -43,6 +45,10 @@ enum class InstructionE {
     DeleteLines,
     InsertCharacters,
     InsertLines,
+    ScrollUp,
+    ScrollDown,
+    SetScrollRegion,
+    ResetScrollRegion,
     Repeat,
     BoldOn,
     BoldOff,
@@ -61,8 +67,22 @@ enum class InstructionE {
     ColorForegroundFull,
     ColorBackgroundFull,
     ResetStyle,
+    StyleTransition,
     SetPaletteColor,
     ResetPalette,
+    SynchronizedUpdateBegin,
+    SynchronizedUpdateEnd,
+};
+
+// 1 based, both lines are part of the region
+struct ScrollRegionParams {
+    uintmax_t _top;
+    uintmax_t _bottom;
+};
+
+struct StyleTransitionParams {
+    uint64_t _from;
+    uint64_t _to;
 };
 
 union InstructionU {
@@ -82,11 +102,15 @@ union InstructionU {
     uintmax_t DeleteLines;
     uintmax_t InsertCharacters;
     uintmax_t InsertLines;
+    uintmax_t ScrollUp;
+    uintmax_t ScrollDown;
+    ScrollRegionParams SetScrollRegion;
     uintmax_t Repeat;
     uint8_t ColorForeground;
     uint8_t ColorBackground;
     Color24 ColorForegroundFull;
     Color24 ColorBackgroundFull;
+    StyleTransitionParams StyleTransition;
     PaletteColor SetPaletteColor;
 };
 
@@ -113,6 +137,10 @@ struct Instruction {
         return {._type = InstructionE::String, ._value = {.String = str}};
     }
 
+    static consteval Instruction createCarriageReturn() {
+        return {._type = InstructionE::CarriageReturn};
+    }
+
     static consteval Instruction createLinefeed() {
         return {._type = InstructionE::Linefeed};
     }
@@ -241,6 +269,28 @@ struct Instruction {
         return {._type = InstructionE::InsertLines, ._value {.InsertLines = n}};
     }
 
+    static inline Instruction createScrollUp(
+        const uintmax_t n
+    ) {
+        return {._type = InstructionE::ScrollUp, ._value {.ScrollUp = n}};
+    }
+
+    static inline Instruction createScrollDown(
+        const uintmax_t n
+    ) {
+        return {._type = InstructionE::ScrollDown, ._value {.ScrollDown = n}};
+    }
+
+    static inline Instruction createSetScrollRegion(
+        const ScrollRegionParams& region
+    ) {
+        return {._type = InstructionE::SetScrollRegion, ._value {.SetScrollRegion = region}};
+    }
+
+    static consteval Instruction createResetScrollRegion() {
+        return {._type = InstructionE::ResetScrollRegion};
+    }
+
     static inline Instruction createRepeat(
         const uintmax_t n
     ) {
@@ -323,6 +373,13 @@ struct Instruction {
         return {._type = InstructionE::ResetStyle};
     }
 
+    static inline Instruction createStyleTransition(
+        const uint64_t from,
+        const uint64_t to
+    ) {
+        return {._type = InstructionE::StyleTransition, ._value = {.StyleTransition = {._from = from, ._to = to}}};
+    }
+
     static inline Instruction createSetPaletteColor(
         const PaletteColor& color
     ) {
@@ -332,9 +389,17 @@ struct Instruction {
     static consteval Instruction createResetPalette() {
         return {._type = InstructionE::ResetPalette};
     }
+
+    static consteval Instruction createSynchronizedUpdateBegin() {
+        return {._type = InstructionE::SynchronizedUpdateBegin};
+    }
+
+    static consteval Instruction createSynchronizedUpdateEnd() {
+        return {._type = InstructionE::SynchronizedUpdateEnd};
+    }
 };
 
-static void streamControlSequence(
+static FlushStatus streamControlSequence(
     Array<uint8_t>& out_buf,
     const Instruction& instr,
     const uintmax_t fd
@@ -345,153 +410,173 @@ static void streamControlSequence(
 
             const uintmax_t octet_c = UTF32::toUTF8Single(utf8, instr._value.Character);
 
-            streamBytes(out_buf, utf8, octet_c, fd);
-        } break;
+            return streamBytes(out_buf, utf8, octet_c, fd);
+        }
         case InstructionE::String: {
-            for(uintmax_t i = 0; i < instr._value.String._n; i++) {
-                uint8_t utf8[4];
-
-                const uintmax_t octet_c = UTF32::toUTF8Single(utf8, instr._value.String._ptr[i]);
-
-                streamBytes(out_buf, utf8, octet_c, fd);
-            }
-        } break;
+            return streamUTF32(out_buf, instr._value.String._ptr, instr._value.String._n, fd);
+        }
+        case InstructionE::CarriageReturn: {
+            return Ctrl::streamCarriageReturn(out_buf, fd);
+        }
         case InstructionE::Linefeed: {
-            Ctrl::streamLinefeed(out_buf, fd);
-        } break;
+            return Ctrl::streamLinefeed(out_buf, fd);
+        }
         case InstructionE::ReverseLinefeed: {
-            Ctrl::streamReverseLinefeed(out_buf, fd);
-        } break;
+            return Ctrl::streamReverseLinefeed(out_buf, fd);
+        }
         case InstructionE::Newline: {
-            Ctrl::streamNewline(out_buf, fd);
-        } break;
+            return Ctrl::streamNewline(out_buf, fd);
+        }
         case InstructionE::CursorUp: {
-            Ctrl::streamCursorUp(out_buf, instr._value.CursorUp, fd);
-        } break;
+            return Ctrl::streamCursorUp(out_buf, instr._value.CursorUp, fd);
+        }
         case InstructionE::CursorDown: {
-            Ctrl::streamCursorDown(out_buf, instr._value.CursorDown, fd);
-        } break;
+            return Ctrl::streamCursorDown(out_buf, instr._value.CursorDown, fd);
+        }
         case InstructionE::CursorForwards: {
-            Ctrl::streamCursorForwards(out_buf, instr._value.CursorForwards, fd);
-        } break;
+            return Ctrl::streamCursorForwards(out_buf, instr._value.CursorForwards, fd);
+        }
         case InstructionE::CursorBackwards: {
-            Ctrl::streamCursorBackwards(out_buf, instr._value.CursorBackwards, fd);
-        } break;
+            return Ctrl::streamCursorBackwards(out_buf, instr._value.CursorBackwards, fd);
+        }
         case InstructionE::CursorPrecedingLine: {
-            Ctrl::streamCursorPrecedingLine(out_buf, instr._value.CursorPrecedingLine, fd);
-        } break;
+            return Ctrl::streamCursorPrecedingLine(out_buf, instr._value.CursorPrecedingLine, fd);
+        }
         case InstructionE::CursorNextLine: {
-            Ctrl::streamCursorNextLine(out_buf, instr._value.CursorNextLine, fd);
-        } break;
+            return Ctrl::streamCursorNextLine(out_buf, instr._value.CursorNextLine, fd);
+        }
         case InstructionE::CursorLineAbsolute: {
-            Ctrl::streamCursorLineAbsolute(out_buf, instr._value.CursorLineAbsolute, fd);
-        } break;
+            return Ctrl::streamCursorLineAbsolute(out_buf, instr._value.CursorLineAbsolute, fd);
+        }
         case InstructionE::CursorCharacterAbsolute: {
-            Ctrl::streamCursorCharacterAbsolute(out_buf, instr._value.CursorCharacterAbsolute, fd);
-        } break;
+            return Ctrl::streamCursorCharacterAbsolute(out_buf, instr._value.CursorCharacterAbsolute, fd);
+        }
         case InstructionE::CursorPositionAbsolute: {
-            Ctrl::streamCursorPositionAbsolute(out_buf, instr._value.CursorPositionAbsolute, fd);
-        } break;
+            return Ctrl::streamCursorPositionAbsolute(out_buf, instr._value.CursorPositionAbsolute, fd);
+        }
         case InstructionE::SaveCursor: {
-            Ctrl::streamSaveCursor(out_buf, fd);
-        } break;
+            return Ctrl::streamSaveCursor(out_buf, fd);
+        }
         case InstructionE::RestoreCursor: {
-            Ctrl::streamRestoreCursor(out_buf, fd);
-        } break;
+            return Ctrl::streamRestoreCursor(out_buf, fd);
+        }
         case InstructionE::EraseCharacters: {
-            Ctrl::streamEraseCharacters(out_buf, instr._value.EraseCharacters, fd);
-        } break;
+            return Ctrl::streamEraseCharacters(out_buf, instr._value.EraseCharacters, fd);
+        }
         case InstructionE::EraseLineForwards: {
-            Ctrl::streamEraseLineForwards(out_buf, fd);
-        } break;
+            return Ctrl::streamEraseLineForwards(out_buf, fd);
+        }
         case InstructionE::EraseLineBackwards: {
-            Ctrl::streamEraseLineBackwards(out_buf, fd);
-        } break;
+            return Ctrl::streamEraseLineBackwards(out_buf, fd);
+        }
         case InstructionE::EraseLine: {
-            Ctrl::streamEraseLine(out_buf, fd);
-        } break;
+            return Ctrl::streamEraseLine(out_buf, fd);
+        }
         case InstructionE::EraseDisplayForwards: {
-            Ctrl::streamEraseDisplayForwards(out_buf, fd);
-        } break;
+            return Ctrl::streamEraseDisplayForwards(out_buf, fd);
+        }
         case InstructionE::EraseDisplayBackwards: {
-            Ctrl::streamEraseDisplayBackwards(out_buf, fd);
-        } break;
+            return Ctrl::streamEraseDisplayBackwards(out_buf, fd);
+        }
         case InstructionE::EraseDisplay: {
-            Ctrl::streamEraseDisplay(out_buf, fd);
-        } break;
+            return Ctrl::streamEraseDisplay(out_buf, fd);
+        }
         case InstructionE::DeleteCharacters: {
-            Ctrl::streamDeleteCharacters(out_buf, instr._value.DeleteCharacters, fd);
-        } break;
+            return Ctrl::streamDeleteCharacters(out_buf, instr._value.DeleteCharacters, fd);
+        }
         case InstructionE::DeleteLines: {
-            Ctrl::streamDeleteLines(out_buf, instr._value.DeleteLines, fd);
-        } break;
+            return Ctrl::streamDeleteLines(out_buf, instr._value.DeleteLines, fd);
+        }
         case InstructionE::InsertCharacters: {
-            Ctrl::streamInsertCharacters(out_buf, instr._value.InsertCharacters, fd);
-        } break;
+            return Ctrl::streamInsertCharacters(out_buf, instr._value.InsertCharacters, fd);
+        }
         case InstructionE::InsertLines: {
-            Ctrl::streamInsertLines(out_buf, instr._value.InsertLines, fd);
-        } break;
+            return Ctrl::streamInsertLines(out_buf, instr._value.InsertLines, fd);
+        }
+        case InstructionE::ScrollUp: {
+            return Ctrl::streamScrollUp(out_buf, instr._value.ScrollUp, fd);
+        }
+        case InstructionE::ScrollDown: {
+            return Ctrl::streamScrollDown(out_buf, instr._value.ScrollDown, fd);
+        }
+        case InstructionE::SetScrollRegion: {
+            return Ctrl::streamSetScrollRegion(out_buf, instr._value.SetScrollRegion._top, instr._value.SetScrollRegion._bottom, fd);
+        }
+        case InstructionE::ResetScrollRegion: {
+            return Ctrl::streamResetScrollRegion(out_buf, fd);
+        }
         case InstructionE::Repeat: {
-            Ctrl::streamRepeat(out_buf, instr._value.Repeat, fd);
-        } break;
+            return Ctrl::streamRepeat(out_buf, instr._value.Repeat, fd);
+        }
         case InstructionE::BoldOn: {
-            Ctrl::streamBoldOn(out_buf, fd);
-        } break;
+            return Ctrl::streamBoldOn(out_buf, fd);
+        }
         case InstructionE::BoldOff: {
-            Ctrl::streamBoldOff(out_buf, fd);
-        } break;
+            return Ctrl::streamBoldOff(out_buf, fd);
+        }
         case InstructionE::ItalicOn: {
-            Ctrl::streamItalicOn(out_buf, fd);
-        } break;
+            return Ctrl::streamItalicOn(out_buf, fd);
+        }
         case InstructionE::ItalicOff: {
-            Ctrl::streamItalicOff(out_buf, fd);
-        } break;
+            return Ctrl::streamItalicOff(out_buf, fd);
+        }
         case InstructionE::UnderlinedOn: {
-            Ctrl::streamUnderlinedOn(out_buf, fd);
-        } break;
+            return Ctrl::streamUnderlinedOn(out_buf, fd);
+        }
         case InstructionE::UnderlinedOff: {
-            Ctrl::streamUnderlinedOff(out_buf, fd);
-        } break;
+            return Ctrl::streamUnderlinedOff(out_buf, fd);
+        }
         case InstructionE::BlinkingOn: {
-            Ctrl::streamBlinkingOn(out_buf, fd);
-        } break;
+            return Ctrl::streamBlinkingOn(out_buf, fd);
+        }
         case InstructionE::BlinkingOff: {
-            Ctrl::streamBlinkingOff(out_buf, fd);
-        } break;
+            return Ctrl::streamBlinkingOff(out_buf, fd);
+        }
         case InstructionE::ReverseOn: {
-            Ctrl::streamReverseOn(out_buf, fd);
-        } break;
+            return Ctrl::streamReverseOn(out_buf, fd);
+        }
         case InstructionE::ReverseOff: {
-            Ctrl::streamReverseOff(out_buf, fd);
-        } break;
+            return Ctrl::streamReverseOff(out_buf, fd);
+        }
         case InstructionE::StrikethroughOn: {
-            Ctrl::streamStrikethroughOn(out_buf, fd);
-        } break;
+            return Ctrl::streamStrikethroughOn(out_buf, fd);
+        }
         case InstructionE::StrikethroughOff: {
-            Ctrl::streamStrikethroughOff(out_buf, fd);
-        } break;
+            return Ctrl::streamStrikethroughOff(out_buf, fd);
+        }
         case InstructionE::ColorForeground: {
-            Ctrl::streamColorForeground(out_buf, instr._value.ColorForeground, fd);
-        } break;
+            return Ctrl::streamColorForeground(out_buf, instr._value.ColorForeground, fd);
+        }
         case InstructionE::ColorBackground: {
-            Ctrl::streamColorBackground(out_buf, instr._value.ColorBackground, fd);
-        } break;
+            return Ctrl::streamColorBackground(out_buf, instr._value.ColorBackground, fd);
+        }
         case InstructionE::ColorForegroundFull: {
-            Ctrl::streamColorForegroundFull(out_buf, instr._value.ColorForegroundFull, fd);
-        } break;
+            return Ctrl::streamColorForegroundFull(out_buf, instr._value.ColorForegroundFull, fd);
+        }
         case InstructionE::ColorBackgroundFull: {
-            Ctrl::streamColorBackgroundFull(out_buf, instr._value.ColorBackgroundFull, fd);
-        } break;
+            return Ctrl::streamColorBackgroundFull(out_buf, instr._value.ColorBackgroundFull, fd);
+        }
         case InstructionE::ResetStyle: {
-            Ctrl::streamResetStyle(out_buf, fd);
-        } break;
+            return Ctrl::streamResetStyle(out_buf, fd);
+        }
+        case InstructionE::StyleTransition: {
+            return Ctrl::streamStyleTransition(out_buf, instr._value.StyleTransition._from, instr._value.StyleTransition._to, fd);
+        }
         case InstructionE::SetPaletteColor: {
-            Ctrl::streamSetPaletteColor(out_buf, instr._value.SetPaletteColor, fd);
-        } break;
+            return Ctrl::streamSetPaletteColor(out_buf, instr._value.SetPaletteColor, fd);
+        }
         case InstructionE::ResetPalette: {
-            Ctrl::streamResetPalette(out_buf, fd);
-        } break;
+            return Ctrl::streamResetPalette(out_buf, fd);
+        }
+        case InstructionE::SynchronizedUpdateBegin: {
+            return Ctrl::streamSynchronizedUpdateBegin(out_buf, fd);
+        }
+        case InstructionE::SynchronizedUpdateEnd: {
+            return Ctrl::streamSynchronizedUpdateEnd(out_buf, fd);
+        }
     }
+
+    return FlushStatus::Done;
 }
 
 static void appendControlSequence(
@@ -507,13 +592,12 @@ static void appendControlSequence(
             dest.appendMulti(utf8, octet_c);
         } break;
         case InstructionE::String: {
-            for(uintmax_t i = 0; i < instr._value.String._n; i++) {
-                uint8_t utf8[4];
+            assert(dest.remaining() >= UTF32::countUTF8(instr._value.String._ptr, instr._value.String._n));
 
-                const uintmax_t octet_c = UTF32::toUTF8Single(utf8, instr._value.String._ptr[i]);
-
-                dest.appendMulti(utf8, octet_c);
-            }
+            dest._n += UTF32::toUTF8Bulk(dest.end(), instr._value.String._ptr, instr._value.String._n);
+        } break;
+        case InstructionE::CarriageReturn: {
+            Ctrl::appendCarriageReturn(dest);
         } break;
         case InstructionE::Linefeed: {
             Ctrl::appendLinefeed(dest);
@@ -590,6 +674,18 @@ static void appendControlSequence(
         case InstructionE::InsertLines: {
             Ctrl::appendInsertLines(dest, instr._value.InsertLines);
         } break;
+        case InstructionE::ScrollUp: {
+            Ctrl::appendScrollUp(dest, instr._value.ScrollUp);
+        } break;
+        case InstructionE::ScrollDown: {
+            Ctrl::appendScrollDown(dest, instr._value.ScrollDown);
+        } break;
+        case InstructionE::SetScrollRegion: {
+            Ctrl::appendSetScrollRegion(dest, instr._value.SetScrollRegion._top, instr._value.SetScrollRegion._bottom);
+        } break;
+        case InstructionE::ResetScrollRegion: {
+            Ctrl::appendResetScrollRegion(dest);
+        } break;
         case InstructionE::Repeat: {
             Ctrl::appendRepeat(dest, instr._value.Repeat);
         } break;
@@ -644,28 +740,41 @@ static void appendControlSequence(
         case InstructionE::ResetStyle: {
             Ctrl::appendResetStyle(dest);
         } break;
+        case InstructionE::StyleTransition: {
+            Ctrl::appendStyleTransition(dest, instr._value.StyleTransition._from, instr._value.StyleTransition._to);
+        } break;
         case InstructionE::SetPaletteColor: {
             Ctrl::appendSetPaletteColor(dest, instr._value.SetPaletteColor);
         } break;
         case InstructionE::ResetPalette: {
             Ctrl::appendResetPalette(dest);
         } break;
+        case InstructionE::SynchronizedUpdateBegin: {
+            Ctrl::appendSynchronizedUpdateBegin(dest);
+        } break;
+        case InstructionE::SynchronizedUpdateEnd: {
+            Ctrl::appendSynchronizedUpdateEnd(dest);
+        } break;
     }
 }
 
-static void emptyInstructionBuffer(
+static FlushStatus emptyInstructionBuffer(
     Array<uint8_t>& out,
     Array<Out::Instruction>& instr_buf,
     const uintmax_t fd
 ) {
+    FlushStatus status = FlushStatus::Done;
+
     for(uintmax_t i = 0; i < instr_buf._n; i++) {
-        streamControlSequence(out, instr_buf._ptr[i], fd);
+        status = mergeFlushStatus(status, streamControlSequence(out, instr_buf._ptr[i], fd));
     }
 
     instr_buf._n = 0;
+
+    return status;
 }
 
-static void streamInstruction(
+static FlushStatus streamInstruction(
     Array<uint8_t>& out,
     Array<Out::Instruction>& instrs,
     const Out::Instruction& instr,
@@ -673,15 +782,17 @@ static void streamInstruction(
 ) {
     if(instrs.remaining() >= 1) {
         instrs.append(instr);
-        return;
+        return FlushStatus::Done;
     }
 
-    emptyInstructionBuffer(out, instrs, fd);
+    const FlushStatus status = emptyInstructionBuffer(out, instrs, fd);
 
     instrs.append(instr);
+
+    return status;
 }
 
-static void streamInstructions(
+static FlushStatus streamInstructions(
     Array<uint8_t>& out,
     Array<Out::Instruction>& instr_buf,
     const Out::Instruction* const src,
@@ -692,7 +803,7 @@ static void streamInstructions(
 
     if(instr_buf_rem >= src_c) {
         instr_buf.appendMulti(src, src_c);
-        return;
+        return FlushStatus::Done;
     }
 
     const Instruction* src_cur = src;
@@ -700,18 +811,20 @@ static void streamInstructions(
     instr_buf.appendMulti(src_cur, instr_buf_rem);
     src_cur += instr_buf_rem;
 
-    emptyInstructionBuffer(out, instr_buf, fd);
+    FlushStatus status = emptyInstructionBuffer(out, instr_buf, fd);
 
     for(uintmax_t i = 0; i < (src_c - instr_buf_rem) / instr_buf._cap; i++) {
         instr_buf.appendMulti(src_cur, instr_buf._cap);
         src_cur += instr_buf._cap;
 
-        emptyInstructionBuffer(out, instr_buf, fd);
+        status = mergeFlushStatus(status, emptyInstructionBuffer(out, instr_buf, fd));
     }
 
     const uintmax_t src_rem = (src_c - instr_buf_rem) % instr_buf._cap;
 
     instr_buf.appendMulti(src_cur, src_rem);
+
+    return status;
 }
 
 }
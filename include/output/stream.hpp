@@ -1,25 +1,103 @@
 #pragma once
 
+#include "output/flush.hpp"
+
 #include "util/array.hpp"
 #include "util/string.hpp"
+#include "util/utf.hpp"
+#include "util/write.hpp"
 
 #include <assert.h>
 #include <stdint.h>
-#include <unistd.h>
+#include <string.h>
+#include <sys/uio.h>
 
 namespace Tesix {
 
 namespace Out {
 
-static inline void emptyOutBuffer(
+// passing this as fd makes the stream functions grow the buffer instead of writing it out, used to assemble output in memory
+constexpr uintmax_t MEMORY_SINK = UINTMAX_MAX;
+
+/**
+ * @brief writes out the whole buffer, waiting for the fd if it is nonblocking and full
+ * for MEMORY_SINK the buffer keeps its contents and grows instead
+ **/
+static inline FlushStatus emptyOutBuffer(
+    Array<uint8_t>& buf,
+    const uintmax_t fd
+) {
+    if(fd == MEMORY_SINK) {
+        buf.reserve(buf._cap > 32 ? buf._cap * 2 : 64);
+        return FlushStatus::Done;
+    }
+
+    if(buf._n == 0) {
+        return FlushStatus::Done;
+    }
+
+    struct iovec iov = {.iov_base = buf._ptr, .iov_len = buf._n};
+
+    const FlushResult res = writeVecAll(fd, &iov, 1);
+
+    buf._n = 0;
+
+    return res._status;
+}
+
+/**
+ * @brief writes out as much of the buffer as the fd accepts without blocking
+ * on FlushStatus::WouldBlock the unwritten bytes are moved to the front of the buffer so the caller can retry later
+ **/
+static FlushStatus tryEmptyOutBuffer(
     Array<uint8_t>& buf,
     const uintmax_t fd
 ) {
-    write(fd, buf._ptr, buf._n);
+    assert(fd != MEMORY_SINK);
+
+    if(buf._n == 0) {
+        return FlushStatus::Done;
+    }
+
+    struct iovec iov = {.iov_base = buf._ptr, .iov_len = buf._n};
+
+    const FlushResult res = writeVec(fd, &iov, 1);
+
+    if(res._status == FlushStatus::WouldBlock) {
+        memmove(buf._ptr, buf._ptr + res._written, buf._n - res._written);
+        buf._n -= res._written;
+
+        return FlushStatus::WouldBlock;
+    }
+
     buf._n = 0;
+
+    return res._status;
+}
+
+/**
+ * @brief makes room for n more bytes, writing the buffer out if the fd takes it without blocking and growing the buffer otherwise
+ * on FlushStatus::WouldBlock nothing is lost, the caller should wait for the fd before it streams much more
+ **/
+static FlushStatus makeRoom(
+    Array<uint8_t>& buf,
+    const uintmax_t n,
+    const uintmax_t fd
+) {
+    FlushStatus status = FlushStatus::Done;
+
+    if(fd != MEMORY_SINK) {
+        status = tryEmptyOutBuffer(buf, fd);
+    }
+
+    if(buf.remaining() < n) {
+        buf.reserve(buf._n + n > buf._cap * 2 ? buf._n + n : buf._cap * 2);
+    }
+
+    return status;
 }
 
-static void const streamByte(
+static FlushStatus streamByte(
     Array<uint8_t>& buf,
     const uint8_t byte,
     const uintmax_t fd
@@ -30,15 +108,17 @@ static void const streamByte(
 
     if(out_buf_rem >= 1) {
         buf.append(byte);
-        return;
+        return FlushStatus::Done;
     }
 
-    emptyOutBuffer(buf, fd);
+    const FlushStatus status = makeRoom(buf, 1, fd);
 
     buf.append(byte);
+
+    return status;
 }
 
-static void streamBytes(
+static FlushStatus streamBytes(
     Array<uint8_t>& buf,
     const uint8_t* const src,
     const uintmax_t src_c,
@@ -46,42 +126,103 @@ static void streamBytes(
 ) {
     assert(buf._cap > 0);
 
-    const uint8_t* src_cur = src;
+    if(buf.remaining() >= src_c) {
+        buf.appendMulti(src, src_c);
+        return FlushStatus::Done;
+    }
 
-    const uintmax_t out_buf_rem = buf.remaining();
+    if(fd == MEMORY_SINK) {
+        buf.reserve(buf._n + src_c > buf._cap * 2 ? buf._n + src_c : buf._cap * 2);
+        buf.appendMulti(src, src_c);
+        return FlushStatus::Done;
+    }
 
-    if(out_buf_rem >= src_c) {
-        buf.appendMulti(src_cur, src_c);
-        return;
+    // hand the pending bytes and src to the kernel together instead of copying src through the buffer
+    struct iovec iov[] = {
+        {.iov_base = buf._ptr, .iov_len = buf._n},
+        {.iov_base = const_cast<uint8_t*>(src), .iov_len = src_c},
+    };
+
+    const FlushResult res = writeVec(fd, iov, countArrayC(iov));
+
+    if(res._status != FlushStatus::WouldBlock) {
+        buf._n = 0;
+        return res._status;
     }
 
-    buf.appendMulti(src_cur, out_buf_rem);
-    src_cur += out_buf_rem;
+    // whatever the fd did not take is kept, first the rest of the buffer and then the rest of src
+    uintmax_t src_written = 0;
+
+    if(res._written < buf._n) {
+        memmove(buf._ptr, buf._ptr + res._written, buf._n - res._written);
+        buf._n -= res._written;
+    } else {
+        src_written = res._written - buf._n;
+        buf._n = 0;
+    }
+
+    buf.reserve(buf._n + src_c - src_written);
+    buf.appendMulti(src + src_written, src_c - src_written);
+
+    return FlushStatus::WouldBlock;
+}
+
+/**
+ * @brief encodes codepoints straight into the buffer, flushing only when the worst case size of the remaining run does not fit
+ **/
+static FlushStatus streamUTF32(
+    Array<uint8_t>& buf,
+    const uint32_t* const src,
+    const uintmax_t src_c,
+    const uintmax_t fd
+) {
+    assert(buf._cap >= 4);
+
+    FlushStatus status = FlushStatus::Done;
+
+    const uint32_t* src_cur = src;
+    uintmax_t src_rem = src_c;
+
+    while(src_rem > 0) {
+        uintmax_t fit = buf.remaining() / 4;
 
-    emptyOutBuffer(buf, fd);
+        if(fit == 0) {
+            status = mergeFlushStatus(status, makeRoom(buf, 4, fd));
 
-    for(uintmax_t i = 0; i < (src_c - out_buf_rem) / buf._cap; i++) {
-        buf.appendMulti(src_cur, buf._cap);
-        src_cur += buf._cap;
+            fit = buf.remaining() / 4;
+        }
 
-        emptyOutBuffer(buf, fd);
+        const uintmax_t take = fit < src_rem ? fit : src_rem;
+
+        buf._n += UTF32::toUTF8Bulk(buf.end(), src_cur, take);
+
+        src_cur += take;
+        src_rem -= take;
     }
 
-    const uintmax_t src_rem = (src_c - out_buf_rem) % buf._cap;
+    return status;
+}
+
+static FlushStatus streamUInt(
+    Array<uint8_t>& buf,
+    const uint8_t val,
+    const uintmax_t fd
+) {
+    const UInt8Digits& digits = UINT8_DIGITS._v[val];
 
-    buf.appendMulti(src_cur, src_rem);
+    return streamBytes(buf, digits._c, digits._n, fd);
 }
 
-static void streamUInt(
+static FlushStatus streamUInt(
     Array<uint8_t>& buf,
     const uintmax_t val,
     const uintmax_t fd
 ) {
-    uint8_t number_buf[21];
+    uint8_t number_buf[20];
 
-    const uintmax_t digits = sprintf(asCStr(number_buf), "%lu", val);
+    const uintmax_t digit_c = writeUInt(number_buf, val) - number_buf;
 
-    return streamBytes(buf, number_buf, digits, fd);
+    return streamBytes(buf, number_buf, digit_c, fd);
 }
 
 }
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "codegen/submit.hpp"
+#include "codegen/state.hpp"
+#include "codegen/instruction.hpp"
+
+#include "output/instruction.hpp"
+#include "output/stream.hpp"
+
+#include "render/frame.hpp"
+#include "render/screen.hpp"
+
+#include "util/buffer.hpp"
+#include "util/array.hpp"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace Tesix {
+
+namespace Render {
+
+// bands shorter than this are not worth a thread handoff
+constexpr uintmax_t BAND_MIN_ROW_C = 8;
+
+struct BandEncoder;
+
+/**
+ * @brief a horizontal slice of the frame and the bytes encoded for it
+ * _state starts every frame unknown, so the band opens with an absolute cursor move and a reset SGR
+ **/
+struct Band {
+    Array<uint8_t> _out;
+    Array<Out::Instruction> _instrs;
+
+    Codegen::State _state;
+
+    uintmax_t _y;
+    uintmax_t _height;
+
+    BandEncoder* _encoder;
+    pthread_t _thread;
+};
+
+/**
+ * @brief encodes a frame in horizontal bands on worker threads, the caller's thread encodes the first band
+ * the bands are concatenated in order, so the output is what a single thread would send minus the moves between bands
+ * threads are started by the first encode, the encoder must not be moved after that
+ **/
+struct BandEncoder {
+    Band* _bands;
+    uintmax_t _band_c;
+
+    // the threads that could be created, bands past _worker_c + 1 stay unused
+    uintmax_t _worker_c;
+
+    bool _started;
+    bool _quit;
+
+    pthread_mutex_t _mutex;
+    pthread_cond_t _work;
+    pthread_cond_t _done;
+
+    // bumped for every frame, workers encode when it differs from the last one they saw
+    uint64_t _generation;
+    uintmax_t _pending;
+
+    // the frame being encoded, _front is nullptr for a full redraw
+    StyledBuffer* _back;
+    StyledBuffer* _front;
+    uintmax_t _columns;
+
+    static inline BandEncoder alloc(
+        const uintmax_t band_c
+    ) {
+        assert(band_c > 0);
+
+        Band* const bands = static_cast<Band*>(malloc(band_c * sizeof(Band)));
+
+        for(uintmax_t i = 0; i < band_c; i++) {
+            bands[i] = {
+                ._out = Array<uint8_t>::alloc(4096),
+                ._instrs = Array<Out::Instruction>::alloc(256),
+                ._state = Codegen::State::initial(),
+                ._y = 0,
+                ._height = 0,
+                ._encoder = nullptr,
+                ._thread = {}
+            };
+        }
+
+        return {
+            ._bands = bands,
+            ._band_c = band_c,
+            ._worker_c = 0,
+            ._started = false,
+            ._quit = false,
+            ._mutex = PTHREAD_MUTEX_INITIALIZER,
+            ._work = PTHREAD_COND_INITIALIZER,
+            ._done = PTHREAD_COND_INITIALIZER,
+            ._generation = 0,
+            ._pending = 0,
+            ._back = nullptr,
+            ._front = nullptr,
+            ._columns = 0
+        };
+    }
+
+    inline void free() {
+        if(_worker_c > 0) {
+            pthread_mutex_lock(&_mutex);
+            _quit = true;
+            pthread_cond_broadcast(&_work);
+            pthread_mutex_unlock(&_mutex);
+
+            for(uintmax_t i = 1; i <= _worker_c; i++) {
+                pthread_join(_bands[i]._thread, nullptr);
+            }
+        }
+
+        for(uintmax_t i = 0; i < _band_c; i++) {
+            _bands[i]._out.free();
+            _bands[i]._instrs.free();
+            _bands[i]._state.free();
+        }
+
+        ::free(_bands);
+
+        pthread_mutex_destroy(&_mutex);
+        pthread_cond_destroy(&_work);
+        pthread_cond_destroy(&_done);
+    }
+};
+
+static void encodeBand(
+    Band& band,
+    const BandEncoder& encoder
+) {
+    band._out._n = 0;
+    band._instrs._n = 0;
+
+    if(band._height == 0) {
+        return;
+    }
+
+    band._state._style = Style::STYLE_UNKNOWN;
+    band._state._cursor_pos = Codegen::CURSOR_UNKNOWN;
+    band._state._last_ch = Codegen::CHARACTER_UNKNOWN;
+    band._state._columns = encoder._columns;
+
+    const FloatingBox area = {
+        ._pos = {._x = 0, ._y = band._y},
+        ._box = {._width = encoder._back->box()._width, ._height = band._height}
+    };
+
+    if(encoder._front != nullptr) {
+        Codegen::submitInstruction(band._out, band._instrs, band._state, Codegen::Instruction::createDiffBuffer({
+            ._pos = area._pos,
+            ._contents = encoder._back->area(area),
+            ._previous = encoder._front->area(area),
+            ._dirty = &encoder._back->_dirty
+        }), Out::MEMORY_SINK);
+    } else {
+        Codegen::submitInstruction(band._out, band._instrs, band._state, Codegen::Instruction::createDrawBuffer({
+            ._pos = area._pos,
+            ._contents = encoder._back->area(area)
+        }), Out::MEMORY_SINK);
+    }
+}
+
+static void* runBandWorker(
+    void* arg
+) {
+    Band& band = *static_cast<Band*>(arg);
+    BandEncoder& encoder = *band._encoder;
+
+    uint64_t generation = 0;
+
+    pthread_mutex_lock(&encoder._mutex);
+
+    while(true) {
+        while(encoder._generation == generation && !encoder._quit) {
+            pthread_cond_wait(&encoder._work, &encoder._mutex);
+        }
+
+        if(encoder._quit) {
+            break;
+        }
+
+        generation = encoder._generation;
+
+        pthread_mutex_unlock(&encoder._mutex);
+
+        encodeBand(band, encoder);
+
+        pthread_mutex_lock(&encoder._mutex);
+
+        encoder._pending -= 1;
+
+        if(encoder._pending == 0) {
+            pthread_cond_signal(&encoder._done);
+        }
+    }
+
+    pthread_mutex_unlock(&encoder._mutex);
+
+    return nullptr;
+}
+
+/**
+ * @brief starts a thread for every band but the first, stops at the first thread the system refuses
+ **/
+static void startBandWorkers(
+    BandEncoder& encoder
+) {
+    for(uintmax_t i = 1; i < encoder._band_c; i++) {
+        encoder._bands[i]._encoder = &encoder;
+
+        if(pthread_create(&encoder._bands[i]._thread, nullptr, runBandWorker, &encoder._bands[i]) != 0) {
+            break;
+        }
+
+        encoder._worker_c = i;
+    }
+
+    encoder._started = true;
+}
+
+/**
+ * @brief same as present() but the rows are encoded in bands on encoder's threads
+ * frames shorter than two bands of BAND_MIN_ROW_C rows are encoded by present(), as is every frame if no worker thread could be started
+ **/
+static Out::FlushStatus presentBands(
+    BandEncoder& encoder,
+    Array<uint8_t>& out_buf,
+    Array<Out::Instruction>& instr_buf,
+    Codegen::State& state,
+    Screen& screen,
+    StyledBuffer& back,
+    const uintmax_t fd
+) {
+    assert(screen._front.box() == back.box());
+
+    state._columns = back.box()._width;
+
+    const uintmax_t height = back.box()._height;
+
+    uintmax_t band_c = height / BAND_MIN_ROW_C;
+
+    if(band_c > encoder._band_c) {
+        band_c = encoder._band_c;
+    }
+
+    if(band_c >= 2 && !encoder._started) {
+        startBandWorkers(encoder);
+    }
+
+    if(band_c > encoder._worker_c + 1) {
+        band_c = encoder._worker_c + 1;
+    }
+
+    if(band_c < 2) {
+        return present(out_buf, instr_buf, state, screen, back, fd);
+    }
+
+    for(uintmax_t i = 0; i <= encoder._worker_c; i++) {
+        Band& band = encoder._bands[i];
+
+        band._y = i < band_c ? height * i / band_c : height;
+        band._height = i < band_c ? height * (i + 1) / band_c - band._y : 0;
+    }
+
+    Out::FlushStatus status = Out::FlushStatus::Done;
+
+    // the bands diff only the rows that changed, against the scrolled front
+    if(screen._valid) {
+        dropUnchangedRows(screen._front, back);
+
+        status = submitScrollDiff(out_buf, instr_buf, state, screen._front, back, fd);
+    }
+
+    pthread_mutex_lock(&encoder._mutex);
+
+    encoder._back = &back;
+    encoder._front = screen._valid ? &screen._front : nullptr;
+    encoder._columns = state._columns;
+
+    encoder._pending = encoder._worker_c;
+    encoder._generation += 1;
+
+    pthread_cond_broadcast(&encoder._work);
+    pthread_mutex_unlock(&encoder._mutex);
+
+    encodeBand(encoder._bands[0], encoder);
+
+    pthread_mutex_lock(&encoder._mutex);
+
+    while(encoder._pending > 0) {
+        pthread_cond_wait(&encoder._done, &encoder._mutex);
+    }
+
+    pthread_mutex_unlock(&encoder._mutex);
+
+    // what was queued before the frame has to reach the terminal before the bands
+    status = Out::mergeFlushStatus(status, Out::emptyInstructionBuffer(out_buf, instr_buf, fd));
+
+    for(uintmax_t i = 0; i < band_c; i++) {
+        const Band& band = encoder._bands[i];
+
+        if(band._out._n == 0) {
+            continue;
+        }
+
+        status = Out::mergeFlushStatus(status, Out::streamBytes(out_buf, band._out._ptr, band._out._n, fd));
+
+        state._style = band._state._style;
+        state._cursor_pos = band._state._cursor_pos;
+        state._last_ch = band._state._last_ch;
+    }
+
+    updateFront(screen, back, encoder._front == nullptr);
+
+    return status;
+}
+
+static inline void submitFrame(
+    Frame& frame,
+    BandEncoder& encoder,
+    Codegen::State& state,
+    Screen& screen,
+    StyledBuffer& back
+) {
+    presentBands(encoder, frame._out, frame._instrs, state, screen, back, Out::MEMORY_SINK);
+}
+
+}
+
+}
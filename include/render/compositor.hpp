@@ -0,0 +1,487 @@
+#pragma once
+
+#include "util/array.hpp"
+#include "util/buffer.hpp"
+#include "util/space.hpp"
+#include "util/style.hpp"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace Tesix {
+
+namespace Render {
+
+// the 4 bit alpha of a 24 bit background that covers what is below it
+constexpr uint8_t BG_ALPHA_OPAQUE = 15;
+
+// background mode, color and alpha of an FCFM style
+constexpr uint64_t BG_MASK = ((uint64_t(1) << 30) - 1) << 26;
+
+/**
+ * @brief a buffer stacked on the output with its top left cell at _pos, the compositor reads it but does not own it
+ * cells with codepoint 0, which a zeroed buffer is full of, are holes the layers below show through
+ * compose() consumes the buffer's dirty rows, a layer buffer must not be presented itself
+ **/
+struct Layer {
+    StyledBuffer* _buffer;
+
+    Position _pos;
+    bool _visible;
+
+    // every cell covers what is below it, no holes and no translucent backgrounds. the layers below are not composed where it is
+    bool _opaque;
+
+    // where the last compose() put the layer, what it covered there is composed again when it moves or hides
+    Position _shown_pos;
+    bool _shown;
+    bool _shown_opaque;
+
+    // the parts of the output it shows in as of the last compose(), Compositor::_regions[_region_begin, _region_begin + _region_c)
+    uintmax_t _region_begin;
+    uintmax_t _region_c;
+};
+
+/**
+ * @brief flattens a stack of layers into one buffer, only cells that a layer wrote, uncovered or covered since the last compose are composed again
+ * the output cells that end up different are marked dirty, so presenting it sends nothing for the rest
+ **/
+struct Compositor {
+    // bottom to top
+    Layer* _layers;
+    uintmax_t _layer_c;
+    uintmax_t _layer_cap;
+
+    // output cells to compose again
+    DirtyRows _damage;
+
+    // the boxes each layer shows in, the ones opaque layers above it cover are cut out
+    Array<FloatingBox> _regions;
+
+    // one output row being composed
+    uint32_t* _row_ch;
+    uint64_t* _row_styles;
+
+    Box _box;
+
+    static inline Compositor alloc(
+        const uintmax_t width,
+        const uintmax_t height,
+        const uintmax_t layer_cap
+    ) {
+        assert(layer_cap > 0);
+
+        return {
+            ._layers = static_cast<Layer*>(malloc(layer_cap * sizeof(Layer))),
+            ._layer_c = 0,
+            ._layer_cap = layer_cap,
+            ._damage = DirtyRows::init(height),
+            ._regions = Array<FloatingBox>::alloc(layer_cap * 4),
+            ._row_ch = static_cast<uint32_t*>(malloc(width * sizeof(uint32_t))),
+            ._row_styles = static_cast<uint64_t*>(malloc(width * sizeof(uint64_t))),
+            ._box = {._width = width, ._height = height}
+        };
+    }
+
+    inline void free() {
+        ::free(_layers);
+        _regions.free();
+        ::free(_row_ch);
+        ::free(_row_styles);
+    }
+};
+
+/**
+ * @brief marks the part of area that is on the output for composing
+ **/
+static void damageArea(
+    Compositor& comp,
+    const FloatingBox& area
+) {
+    if(area._pos._x >= comp._box._width || area._pos._y >= comp._box._height) {
+        return;
+    }
+
+    const uintmax_t end_x = area._pos._x + area._box._width < comp._box._width ? area._pos._x + area._box._width : comp._box._width;
+    const uintmax_t end_y = area._pos._y + area._box._height < comp._box._height ? area._pos._y + area._box._height : comp._box._height;
+
+    if(end_x <= area._pos._x) {
+        return;
+    }
+
+    for(uintmax_t y = area._pos._y; y < end_y; y++) {
+        comp._damage.mark(y, area._pos._x, end_x);
+    }
+}
+
+static inline FloatingBox layerArea(
+    const Layer& layer,
+    const Position& pos
+) {
+    return {._pos = pos, ._box = layer._buffer->box()};
+}
+
+/**
+ * @brief stacks buffer on top of the other layers, returns its index
+ **/
+static uintmax_t pushLayer(
+    Compositor& comp,
+    StyledBuffer& buffer,
+    const Position& pos
+) {
+    assert(comp._layer_c < comp._layer_cap);
+
+    comp._layers[comp._layer_c] = {
+        ._buffer = &buffer,
+        ._pos = pos,
+        ._visible = true,
+        ._opaque = false,
+        ._shown_pos = pos,
+        ._shown = false,
+        ._shown_opaque = false,
+        ._region_begin = 0,
+        ._region_c = 0
+    };
+
+    return comp._layer_c++;
+}
+
+/**
+ * @brief takes layer i off the stack, the layers above it move down one index
+ **/
+static void removeLayer(
+    Compositor& comp,
+    const uintmax_t i
+) {
+    assert(i < comp._layer_c);
+
+    const Layer& layer = comp._layers[i];
+
+    if(layer._shown) {
+        damageArea(comp, layerArea(layer, layer._shown_pos));
+    }
+
+    for(uintmax_t j = i; j + 1 < comp._layer_c; j++) {
+        comp._layers[j] = comp._layers[j + 1];
+    }
+
+    comp._layer_c--;
+}
+
+/**
+ * @brief moves layer i on top of the others, the layers above it move down one index
+ **/
+static void raiseLayer(
+    Compositor& comp,
+    const uintmax_t i
+) {
+    assert(i < comp._layer_c);
+
+    const Layer layer = comp._layers[i];
+
+    for(uintmax_t j = i; j + 1 < comp._layer_c; j++) {
+        comp._layers[j] = comp._layers[j + 1];
+    }
+
+    comp._layers[comp._layer_c - 1] = layer;
+
+    if(layer._shown) {
+        damageArea(comp, layerArea(layer, layer._shown_pos));
+    }
+}
+
+/**
+ * @brief finds the boxes of the output each layer shows in, from the top layer down
+ **/
+static void findVisibleRegions(
+    Compositor& comp
+) {
+    Array<FloatingBox>& regions = comp._regions;
+
+    regions._n = 0;
+
+    const FloatingBox output = {._pos = {._x = 0, ._y = 0}, ._box = comp._box};
+
+    for(uintmax_t i = comp._layer_c; i-- > 0;) {
+        Layer& layer = comp._layers[i];
+
+        layer._region_begin = regions._n;
+        layer._region_c = 0;
+
+        if(!layer._visible) {
+            continue;
+        }
+
+        const FloatingBox area = intersect(layerArea(layer, layer._pos), output);
+
+        if(!area.takesUpSpace()) {
+            continue;
+        }
+
+        if(regions.remaining() < 1) {
+            regions.reserve(regions._cap * 2);
+        }
+
+        regions.append(area);
+
+        for(uintmax_t j = i + 1; j < comp._layer_c && regions._n > layer._region_begin; j++) {
+            const Layer& above = comp._layers[j];
+
+            if(!above._visible || !above._opaque) {
+                continue;
+            }
+
+            const FloatingBox cover = layerArea(above, above._pos);
+
+            // the pieces are appended behind the boxes they are cut from, then moved over them
+            const uintmax_t end = regions._n;
+
+            for(uintmax_t k = layer._region_begin; k < end; k++) {
+                if(regions.remaining() < 4) {
+                    regions.reserve(regions._cap * 2 + 4);
+                }
+
+                regions._n += subtract(regions._ptr[k], cover, regions.end());
+            }
+
+            memmove(regions._ptr + layer._region_begin, regions._ptr + end, (regions._n - end) * sizeof(FloatingBox));
+
+            regions._n = layer._region_begin + regions._n - end;
+        }
+
+        layer._region_c = regions._n - layer._region_begin;
+    }
+}
+
+/**
+ * @brief marks the part of area (in output cells) that layer shows in for composing
+ **/
+static void damageVisible(
+    Compositor& comp,
+    const Layer& layer,
+    const FloatingBox& area
+) {
+    for(uintmax_t k = 0; k < layer._region_c; k++) {
+        damageArea(comp, intersect(comp._regions._ptr[layer._region_begin + k], area));
+    }
+}
+
+/**
+ * @brief false if no cell of area, in layer i's own cells, showed in the last compose(), drawing it can be skipped
+ * a layer that was not composed yet counts as visible, skipped cells have to be drawn before the layers covering them move away
+ **/
+static bool isAreaVisible(
+    const Compositor& comp,
+    const uintmax_t i,
+    const FloatingBox& area
+) {
+    assert(i < comp._layer_c);
+
+    const Layer& layer = comp._layers[i];
+
+    if(!layer._shown) {
+        return layer._visible;
+    }
+
+    const FloatingBox placed = {._pos = layer._shown_pos + area._pos, ._box = area._box};
+
+    for(uintmax_t k = 0; k < layer._region_c; k++) {
+        if(overlap(comp._regions._ptr[layer._region_begin + k], placed)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief turns what changed about the layers since the last compose into damage, writes to covered cells cause none
+ **/
+static void collectDamage(
+    Compositor& comp
+) {
+    for(uintmax_t i = 0; i < comp._layer_c; i++) {
+        Layer& layer = comp._layers[i];
+        DirtyRows& dirty = layer._buffer->_dirty;
+
+        const bool moved = !(layer._pos == layer._shown_pos) || layer._opaque != layer._shown_opaque;
+
+        if(layer._shown && (!layer._visible || moved)) {
+            damageArea(comp, layerArea(layer, layer._shown_pos));
+        }
+
+        if(layer._visible && (!layer._shown || moved)) {
+            damageVisible(comp, layer, layerArea(layer, layer._pos));
+        } else if(layer._visible) {
+            for(uintmax_t y = dirty.nextDirty(0); y < dirty._height; y = dirty.nextDirty(y + 1)) {
+                const DirtySpan& span = dirty._spans[y];
+
+                damageVisible(comp, layer, {
+                    ._pos = {._x = layer._pos._x + span._begin, ._y = layer._pos._y + y},
+                    ._box = {._width = span._end - span._begin, ._height = 1}
+                });
+            }
+        }
+
+        dirty.clear();
+
+        layer._shown = layer._visible;
+        layer._shown_pos = layer._pos;
+        layer._shown_opaque = layer._opaque;
+    }
+}
+
+static inline uint8_t mixChannel(
+    const uint8_t top,
+    const uint8_t below,
+    const uint8_t alpha
+) {
+    return (top * alpha + below * (BG_ALPHA_OPAQUE - alpha) + BG_ALPHA_OPAQUE / 2) / BG_ALPHA_OPAQUE;
+}
+
+/**
+ * @brief the translucent 24 bit background of top over the background of below, in below's bits
+ * default and palette colors are unknown to us and can not be mixed, whichever side is more opaque wins
+ **/
+static inline uint64_t blendBackground(
+    const uint64_t top,
+    uint64_t below
+) {
+    const uint8_t alpha = Style::FCFM::getFCBgA(top);
+
+    if(Style::FCFM::getBgMode(below) != Style::ColorMode::FullColor) {
+        return alpha * 2 > BG_ALPHA_OPAQUE ? top : below;
+    }
+
+    Style::FCFM::setFCBgR(below, mixChannel(Style::FCFM::getFCBgR(top), Style::FCFM::getFCBgR(below), alpha));
+    Style::FCFM::setFCBgG(below, mixChannel(Style::FCFM::getFCBgG(top), Style::FCFM::getFCBgG(below), alpha));
+    Style::FCFM::setFCBgB(below, mixChannel(Style::FCFM::getFCBgB(top), Style::FCFM::getFCBgB(below), alpha));
+
+    return below;
+}
+
+/**
+ * @brief stacks ch in style over the cell ch_below / style_below
+ * a character replaces the cell, a blank on a translucent background tints it and keeps the character below visible
+ **/
+static inline void blendCell(
+    uint32_t& ch_below,
+    uint64_t& style_below,
+    const uint32_t ch,
+    const uint64_t style
+) {
+    if(ch == 0) {
+        return;
+    }
+
+    if(Style::FCFM::getBgMode(style) != Style::ColorMode::FullColor || Style::FCFM::getFCBgA(style) == BG_ALPHA_OPAQUE) {
+        ch_below = ch;
+        style_below = style;
+        return;
+    }
+
+    const uint64_t bg = blendBackground(style, style_below) & BG_MASK;
+
+    if(ch != ' ') {
+        ch_below = ch;
+        style_below = style;
+    }
+
+    style_below = (style_below & ~BG_MASK) | bg;
+}
+
+/**
+ * @brief composes columns [begin, end) of output row y and writes the cells that changed to out
+ **/
+static void composeSpan(
+    Compositor& comp,
+    StyledBuffer& out,
+    const uintmax_t y,
+    const uintmax_t begin,
+    const uintmax_t end
+) {
+    uint32_t* const row_ch = comp._row_ch;
+    uint64_t* const row_styles = comp._row_styles;
+
+    for(uintmax_t x = begin; x < end; x++) {
+        row_ch[x] = ' ';
+        row_styles[x] = 0;
+    }
+
+    for(uintmax_t i = 0; i < comp._layer_c; i++) {
+        const Layer& layer = comp._layers[i];
+
+        const StyledBufferArea cells = layer._buffer->all();
+
+        // only where the layer shows, the opaque layers above replace the rest
+        for(uintmax_t k = 0; k < layer._region_c; k++) {
+            const FloatingBox& region = comp._regions._ptr[layer._region_begin + k];
+
+            if(y < region._pos._y || y >= region._pos._y + region._box._height) {
+                continue;
+            }
+
+            const uintmax_t from = region._pos._x > begin ? region._pos._x : begin;
+            const uintmax_t to = region._pos._x + region._box._width < end ? region._pos._x + region._box._width : end;
+
+            for(uintmax_t x = from; x < to; x++) {
+                const Position pos = Position::create(x - layer._pos._x, y - layer._pos._y);
+
+                blendCell(row_ch[x], row_styles[x], cells.ch(pos), cells.styleValue(pos));
+            }
+        }
+    }
+
+    const StyledBufferArea shown = out.all();
+
+    uintmax_t changed_begin = end;
+    uintmax_t changed_end = begin;
+
+    for(uintmax_t x = begin; x < end; x++) {
+        const Position pos = Position::create(x, y);
+
+        if(shown.ch(pos) == row_ch[x] && shown.styleValue(pos) == row_styles[x]) {
+            continue;
+        }
+
+        out.set(pos, row_ch[x], Style::StyleContainer::createValue(row_styles[x]));
+
+        if(x < changed_begin) {
+            changed_begin = x;
+        }
+
+        changed_end = x + 1;
+    }
+
+    if(changed_begin < changed_end) {
+        out.markDirty(Position::create(changed_begin, y), changed_end - changed_begin);
+    }
+}
+
+/**
+ * @brief brings out up to date with the layers, out has to be as big as the compositor
+ * cells no visible layer covers are blanks in the default style
+ **/
+static void compose(
+    Compositor& comp,
+    StyledBuffer& out
+) {
+    assert(out.box() == comp._box);
+
+    findVisibleRegions(comp);
+    collectDamage(comp);
+
+    for(uintmax_t y = comp._damage.nextDirty(0); y < comp._box._height; y = comp._damage.nextDirty(y + 1)) {
+        const DirtySpan& span = comp._damage._spans[y];
+
+        composeSpan(comp, out, y, span._begin, span._end);
+    }
+
+    comp._damage.clear();
+}
+
+}
+
+}
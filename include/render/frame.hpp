@@ -0,0 +1,95 @@
+#pragma once
+
+#include "codegen/state.hpp"
+
+#include "output/instruction.hpp"
+#include "output/stream.hpp"
+#include "output/flush.hpp"
+
+#include "render/screen.hpp"
+
+#include "util/buffer.hpp"
+#include "util/array.hpp"
+
+#include <stdint.h>
+
+namespace Tesix {
+
+namespace Render {
+
+/**
+ * @brief assembles a whole frame in memory so it reaches the terminal in a single write
+ * with _sync the frame is bracketed by a synchronized update (DEC mode 2026), terminals without support ignore the mode
+ **/
+struct Frame {
+    Array<uint8_t> _out;
+    Array<Out::Instruction> _instrs;
+
+    bool _sync;
+
+    static inline Frame alloc(
+        const uintmax_t out_cap,
+        const uintmax_t instr_cap,
+        const bool sync
+    ) {
+        return {
+            ._out = Array<uint8_t>::alloc(out_cap),
+            ._instrs = Array<Out::Instruction>::alloc(instr_cap),
+            ._sync = sync
+        };
+    }
+
+    inline void free() {
+        _out.free();
+        _instrs.free();
+    }
+};
+
+static void beginFrame(
+    Frame& frame
+) {
+    frame._out._n = 0;
+    frame._instrs._n = 0;
+
+    if(frame._sync) {
+        Out::streamInstruction(frame._out, frame._instrs, Out::Instruction::createSynchronizedUpdateBegin(), Out::MEMORY_SINK);
+    }
+}
+
+static inline void submitFrame(
+    Frame& frame,
+    Codegen::State& state,
+    Screen& screen,
+    StyledBuffer& back
+) {
+    present(frame._out, frame._instrs, state, screen, back, Out::MEMORY_SINK);
+}
+
+/**
+ * @brief closes the frame and encodes the pending instructions, afterwards _out holds every byte of the frame
+ **/
+static void finishFrame(
+    Frame& frame
+) {
+    if(frame._sync) {
+        Out::streamInstruction(frame._out, frame._instrs, Out::Instruction::createSynchronizedUpdateEnd(), Out::MEMORY_SINK);
+    }
+
+    Out::emptyInstructionBuffer(frame._out, frame._instrs, Out::MEMORY_SINK);
+}
+
+/**
+ * @brief encodes the pending instructions and hands the frame to the terminal with one write
+ **/
+static Out::FlushStatus endFrame(
+    Frame& frame,
+    const uintmax_t fd
+) {
+    finishFrame(frame);
+
+    return Out::emptyOutBuffer(frame._out, fd);
+}
+
+}
+
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "output/flush.hpp"
+#include "output/stream.hpp"
+
+#include "render/frame.hpp"
+
+#include "util/term.hpp"
+
+#include <stdint.h>
+
+namespace Tesix {
+
+namespace Render {
+
+/**
+ * @brief decides when the next frame may be presented from how fast the terminal takes the previous ones
+ * the interval doubles when writing a frame takes more than half of it or the tty's output queue is over _outq_limit
+ * otherwise it shrinks by a quarter, but not below twice the write latency
+ * updates that are not presented are coalesced: they stay in the back buffer's dirty rows and go out with the next frame
+ * the fd has to be O_NONBLOCK (see enableNonblocking()), a blocking write returns once the kernel copied the frame,
+ * so the latency would only measure that copy and a pty's TIOCOUTQ stays 0 even while the terminal falls behind
+ **/
+struct FramePacer {
+    uint64_t _min_interval_ns;
+    uint64_t _max_interval_ns;
+    uint64_t _interval_ns;
+
+    // earliest time the next frame may be presented
+    uint64_t _next_ns;
+
+    // when the frame that is still being written started, 0 if nothing is pending
+    uint64_t _write_start_ns;
+
+    // smoothed time from the start of a frame's write until the terminal took all of it
+    uint64_t _latency_ns;
+
+    // bytes the tty's output queue may hold before presenting waits, 0 disables the check
+    uintmax_t _outq_limit;
+
+    // updates skipped since the last presented frame
+    uintmax_t _coalesced_c;
+
+    static inline FramePacer init(
+        const uint64_t min_interval_ns,
+        const uint64_t max_interval_ns,
+        const uintmax_t outq_limit
+    ) {
+        return {
+            ._min_interval_ns = min_interval_ns,
+            ._max_interval_ns = max_interval_ns,
+            ._interval_ns = min_interval_ns,
+            ._next_ns = 0,
+            ._write_start_ns = 0,
+            ._latency_ns = 0,
+            ._outq_limit = outq_limit,
+            ._coalesced_c = 0
+        };
+    }
+
+    inline void slowDown() {
+        _interval_ns = _interval_ns * 2 < _max_interval_ns ? _interval_ns * 2 : _max_interval_ns;
+    }
+
+    inline void speedUp() {
+        uint64_t interval = _interval_ns - _interval_ns / 4;
+
+        if(interval < _latency_ns * 2) {
+            interval = _latency_ns * 2;
+        }
+
+        _interval_ns = interval > _min_interval_ns ? interval : _min_interval_ns;
+    }
+
+    /**
+     * @brief records that the pending frame reached the terminal at now_ns
+     **/
+    inline void finishWrite(
+        const uint64_t now_ns
+    ) {
+        const uint64_t latency = now_ns - _write_start_ns;
+
+        _latency_ns = _latency_ns == 0 ? latency : (_latency_ns * 3 + latency) / 4;
+        _write_start_ns = 0;
+
+        if(_latency_ns > _interval_ns / 2) {
+            slowDown();
+        } else {
+            speedUp();
+        }
+    }
+
+    inline uint64_t nanosUntilDue() const {
+        const uint64_t now = monotonicNs();
+
+        return _next_ns > now ? _next_ns - now : 0;
+    }
+};
+
+/**
+ * @brief true if a frame should be presented now, false if this update should be coalesced into a later one
+ * while the previous frame is still being written this keeps writing it, beginFrame() must not be called until this returns true
+ * the write is only timed when this is called, call it as soon as poll() reports fd writable or the wait counts as latency
+ **/
+static bool isFrameDue(
+    FramePacer& pacer,
+    Frame& frame,
+    const uintmax_t fd
+) {
+    if(frame._out._n > 0) {
+        const Out::FlushStatus status = Out::tryEmptyOutBuffer(frame._out, fd);
+
+        if(status == Out::FlushStatus::WouldBlock) {
+            pacer._coalesced_c += 1;
+            return false;
+        }
+
+        // a failed write drops the rest of the frame, the fd fails the next endFramePaced() the same way
+        if(status == Out::FlushStatus::Done) {
+            pacer.finishWrite(monotonicNs());
+        } else {
+            pacer._write_start_ns = 0;
+        }
+    }
+
+    const uint64_t now = monotonicNs();
+
+    if(now < pacer._next_ns) {
+        pacer._coalesced_c += 1;
+        return false;
+    }
+
+    if(pacer._outq_limit > 0 && pendingOutputBytes(fd) > pacer._outq_limit) {
+        pacer.slowDown();
+        pacer._next_ns = now + pacer._interval_ns;
+
+        pacer._coalesced_c += 1;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief blocks until isFrameDue() returns true, waiting in poll() while the previous frame is still being written
+ * the frame's write is timed when its last byte is taken, for applications that have nothing else to wait on
+ **/
+static void waitFrameDue(
+    FramePacer& pacer,
+    Frame& frame,
+    const uintmax_t fd
+) {
+    while(!isFrameDue(pacer, frame, fd)) {
+        // an fd that fails here fails the write in isFrameDue() too, which drops the frame
+        if(frame._out._n > 0) {
+            Out::waitWritable(fd);
+        } else {
+            msleep(pacer.nanosUntilDue() / 1000000 + 1);
+        }
+    }
+}
+
+/**
+ * @brief endFrame() that does not block on a congested O_NONBLOCK fd
+ * on FlushStatus::WouldBlock the rest of the frame stays in frame._out and isFrameDue() or waitFrameDue() finishes writing it,
+ * the frame's latency lasts until its last byte was written, which is what slows the pacer down for a slow terminal
+ **/
+static Out::FlushStatus endFramePaced(
+    FramePacer& pacer,
+    Frame& frame,
+    const uintmax_t fd
+) {
+    finishFrame(frame);
+
+    const uint64_t start = monotonicNs();
+
+    pacer._write_start_ns = start;
+    pacer._coalesced_c = 0;
+
+    const Out::FlushStatus status = Out::tryEmptyOutBuffer(frame._out, fd);
+
+    if(status == Out::FlushStatus::Done) {
+        pacer.finishWrite(monotonicNs());
+    }
+
+    pacer._next_ns = start + pacer._interval_ns;
+
+    return status;
+}
+
+}
+
+}
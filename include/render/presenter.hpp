@@ -0,0 +1,183 @@
+#pragma once
+
+#include "codegen/state.hpp"
+
+#include "output/flush.hpp"
+
+#include "render/frame.hpp"
+#include "render/screen.hpp"
+
+#include "util/buffer.hpp"
+
+#include <atomic>
+#include <pthread.h>
+#include <stdint.h>
+
+namespace Tesix {
+
+namespace Render {
+
+// layout of Presenter::_handoff, the slot the last published frame is in and whether the render thread has taken it
+constexpr uint32_t PRESENTER_SLOT_MASK = 0b11;
+constexpr uint32_t PRESENTER_FRESH = 0b100;
+constexpr uint32_t PRESENTER_QUIT = 0b1000;
+
+/**
+ * @brief presents frames on a render thread so a slow terminal never blocks the application
+ * the application publishes snapshots through a single producer single consumer triple buffer:
+ * it copies into _slots[_write_i], the render thread presents _slots[_read_i] and the third slot is handed between them
+ * a frame that is published before the render thread took the previous one replaces it, the older one is dropped
+ * the thread is started by the first publish, the presenter must not be moved after that
+ * while the system refuses to start it, publishFrame() presents on the application thread and blocks like endFrame()
+ **/
+struct Presenter {
+    StyledBuffer _slots[3];
+
+    // owned by the application thread
+    uint32_t _write_i;
+
+    // owned by the render thread
+    uint32_t _read_i;
+
+    std::atomic<uint32_t> _handoff;
+
+    std::atomic<uintmax_t> _presented_c;
+    std::atomic<uintmax_t> _dropped_c;
+
+    // only touched by the render thread once it is started
+    Screen _screen;
+    Frame _frame;
+    Codegen::State _state;
+    uintmax_t _fd;
+
+    // status of the last write, FlushStatus::Done if everything reached the terminal
+    std::atomic<Out::FlushStatus> _status;
+
+    pthread_t _thread;
+    bool _started;
+
+    static inline Presenter alloc(
+        const uintmax_t width,
+        const uintmax_t height,
+        const uintmax_t fd,
+        const bool sync
+    ) {
+        return {
+            ._slots = {
+                StyledBuffer::init(width, height),
+                StyledBuffer::init(width, height),
+                StyledBuffer::init(width, height)
+            },
+            ._write_i = 0,
+            ._read_i = 2,
+            ._handoff = 1,
+            ._presented_c = 0,
+            ._dropped_c = 0,
+            ._screen = Screen::init(width, height),
+            ._frame = Frame::alloc(4096, 256, sync),
+            ._state = Codegen::State::initial(),
+            ._fd = fd,
+            ._status = Out::FlushStatus::Done,
+            ._thread = {},
+            ._started = false
+        };
+    }
+
+    /**
+     * @brief stops the render thread once it presented the last published frame
+     **/
+    inline void free() {
+        if(_started) {
+            _handoff.fetch_or(PRESENTER_QUIT, std::memory_order_release);
+            _handoff.notify_one();
+
+            pthread_join(_thread, nullptr);
+        }
+
+        _frame.free();
+        _state.free();
+    }
+};
+
+static void* runPresenter(
+    void* arg
+) {
+    Presenter& presenter = *static_cast<Presenter*>(arg);
+
+    while(true) {
+        uint32_t handoff = presenter._handoff.load(std::memory_order_acquire);
+
+        while((handoff & (PRESENTER_FRESH | PRESENTER_QUIT)) == 0) {
+            presenter._handoff.wait(handoff, std::memory_order_acquire);
+
+            handoff = presenter._handoff.load(std::memory_order_acquire);
+        }
+
+        if((handoff & PRESENTER_FRESH) == 0) {
+            break;
+        }
+
+        // free() may set PRESENTER_QUIT at any time, it has to survive the swap
+        while(!presenter._handoff.compare_exchange_weak(handoff, (handoff & PRESENTER_QUIT) | presenter._read_i, std::memory_order_acq_rel)) {
+        }
+
+        presenter._read_i = handoff & PRESENTER_SLOT_MASK;
+
+        beginFrame(presenter._frame);
+
+        submitFrame(presenter._frame, presenter._state, presenter._screen, presenter._slots[presenter._read_i]);
+
+        presenter._status.store(endFrame(presenter._frame, presenter._fd), std::memory_order_relaxed);
+        presenter._presented_c.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief hands a snapshot of back to the render thread and returns without waiting for the terminal
+ * back is copied, the application keeps drawing into it, its dirty rows are cleared
+ **/
+static void publishFrame(
+    Presenter& presenter,
+    StyledBuffer& back
+) {
+    if(!presenter._started) {
+        presenter._started = pthread_create(&presenter._thread, nullptr, runPresenter, &presenter) == 0;
+    }
+
+    // without a render thread nothing else touches the screen and frame, the next publish tries to start it again
+    if(!presenter._started) {
+        beginFrame(presenter._frame);
+
+        submitFrame(presenter._frame, presenter._state, presenter._screen, back);
+
+        presenter._status.store(endFrame(presenter._frame, presenter._fd), std::memory_order_relaxed);
+        presenter._presented_c.fetch_add(1, std::memory_order_relaxed);
+
+        return;
+    }
+
+    StyledBuffer& slot = presenter._slots[presenter._write_i];
+
+    // slots skip the frames published into the other two, so every row is compared against the front
+    slot.copy(back, Position::create(0, 0), back.box().size());
+    slot.markAllDirty();
+    slot.mirrorRowHashes(back);
+
+    back._dirty.clear();
+
+    const uint32_t prev = presenter._handoff.exchange(presenter._write_i | PRESENTER_FRESH, std::memory_order_acq_rel);
+
+    presenter._write_i = prev & PRESENTER_SLOT_MASK;
+
+    if((prev & PRESENTER_FRESH) != 0) {
+        presenter._dropped_c.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    presenter._handoff.notify_one();
+}
+
+}
+
+}
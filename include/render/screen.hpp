@@ -0,0 +1,135 @@
+#pragma once
+
+#include "codegen/submit.hpp"
+#include "codegen/state.hpp"
+#include "codegen/instruction.hpp"
+
+#include "output/instruction.hpp"
+
+#include "render/scroll.hpp"
+
+#include "util/buffer.hpp"
+#include "util/array.hpp"
+
+#include <stdint.h>
+
+namespace Tesix {
+
+namespace Render {
+
+/**
+ * @brief holds the last presented frame so following frames only have to send the cells that changed
+ **/
+struct Screen {
+    StyledBuffer _front;
+
+    // false until _front mirrors what the terminal shows
+    bool _valid;
+
+    static inline Screen init(
+        const uintmax_t width,
+        const uintmax_t height
+    ) {
+        return {
+            ._front = StyledBuffer::init(width, height),
+            ._valid = false
+        };
+    }
+
+    inline void invalidate() {
+        _valid = false;
+    }
+};
+
+/**
+ * @brief makes _front match back once back was sent to the terminal and clears back's dirty rows
+ * with full every cell is copied, otherwise only the dirty spans
+ **/
+static void updateFront(
+    Screen& screen,
+    StyledBuffer& back,
+    const bool full
+) {
+    // a renumbered style palette invalidates the style ids of clean rows too
+    if(full || !screen._front.sharesStyleKeys(back)) {
+        screen._front.copy(back, Position::create(0, 0), back.box().size());
+    } else {
+        for(uintmax_t y = back._dirty.nextDirty(0); y < back._dirty._height; y = back._dirty.nextDirty(y + 1)) {
+            const DirtySpan& span = back._dirty._spans[y];
+
+            screen._front.copy(back, Position::create(span._begin, y), span._end - span._begin);
+        }
+    }
+
+    screen._front.mirrorRowHashes(back);
+
+    screen._valid = true;
+
+    back._dirty.clear();
+}
+
+/**
+ * @brief unmarks the dirty rows of back that are equal to front's rows, the diff skips them
+ * the hashes rule out most changed rows without comparing their cells, so an application that redraws everything every frame
+ * only pays a row compare for the rows that did not change
+ **/
+static void dropUnchangedRows(
+    StyledBuffer& front,
+    StyledBuffer& back
+) {
+    assert(front.box() == back.box());
+
+    for(uintmax_t y = back._dirty.nextDirty(0); y < back._dirty._height; y = back._dirty.nextDirty(y + 1)) {
+        if(back.rowHash(y) == front.rowHash(y) && rowsEqual(back, y, front, y)) {
+            back._dirty.unmark(y);
+        }
+    }
+}
+
+/**
+ * @brief sends back to the terminal and makes it the new front
+ * back has to be the buffer presented last time, its dirty rows are what changed since then and are cleared here
+ * rows that moved up or down since then are scrolled instead of redrawn
+ **/
+static Out::FlushStatus present(
+    Array<uint8_t>& out_buf,
+    Array<Out::Instruction>& instr_buf,
+    Codegen::State& state,
+    Screen& screen,
+    StyledBuffer& back,
+    const uintmax_t fd
+) {
+    assert(screen._front.box() == back.box());
+
+    // the screen spans the whole terminal, the cursor planner needs its width to tell when a write left the cursor waiting to wrap
+    state._columns = back.box()._width;
+
+    Out::FlushStatus status = Out::FlushStatus::Done;
+
+    if(screen._valid) {
+        dropUnchangedRows(screen._front, back);
+
+        status = submitScrollDiff(out_buf, instr_buf, state, screen._front, back, fd);
+
+        status = Out::mergeFlushStatus(status, Codegen::submitInstruction(out_buf, instr_buf, state, Codegen::Instruction::createDiffBuffer({
+            ._pos = {._x = 0, ._y = 0},
+            ._contents = back.all(),
+            ._previous = screen._front.all(),
+            ._dirty = &back._dirty
+        }), fd));
+
+        updateFront(screen, back, false);
+    } else {
+        status = Codegen::submitInstruction(out_buf, instr_buf, state, Codegen::Instruction::createDrawBuffer({
+            ._pos = {._x = 0, ._y = 0},
+            ._contents = back.all()
+        }), fd);
+
+        updateFront(screen, back, true);
+    }
+
+    return status;
+}
+}
+
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include "codegen/submit.hpp"
+#include "codegen/state.hpp"
+#include "codegen/instruction.hpp"
+
+#include "output/instruction.hpp"
+
+#include "util/buffer.hpp"
+#include "util/array.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace Tesix {
+
+namespace Render {
+
+// a scroll is only sent when it saves redrawing at least this many rows
+constexpr uintmax_t SCROLL_MIN_ROW_C = 2;
+
+// distinct shifts that are tried, rows that moved by any other amount are redrawn
+constexpr uintmax_t SCROLL_CANDIDATE_C = 8;
+
+// ScrollSlot::_row of a hash that more than one front row has, such rows (blank ones mostly) say nothing about a shift
+constexpr uintmax_t SCROLL_ROW_REPEATED = UINTMAX_MAX;
+
+struct ScrollSlot {
+    uint64_t _hash;
+
+    // row + 1, 0 for an empty slot
+    uintmax_t _row;
+};
+
+struct ScrollRun {
+    // back rows _begin to _end (both included) are front rows shifted by _shift, positive if they moved up
+    uintmax_t _begin;
+    uintmax_t _end;
+    intmax_t _shift;
+
+    // rows the scroll saves redrawing minus the rows it blanks that were up to date
+    intmax_t _gain;
+};
+
+static bool rowsEqual(
+    const StyledBuffer& a,
+    const uintmax_t a_y,
+    const StyledBuffer& b,
+    const uintmax_t b_y
+) {
+    const uintmax_t width = a.box()._width;
+
+    for(uintmax_t x = 0; x < width; x++) {
+#if defined(TESIX_PACKED_CELLS)
+        const Cell& a_cell = a._cells._ptr[a_y * width + x];
+        const Cell& b_cell = b._cells._ptr[b_y * width + x];
+
+        if(a_cell._ch != b_cell._ch || a_cell._style != b_cell._style) {
+            return false;
+        }
+#else
+        if(a._ch._ptr[a_y * width + x] != b._ch._ptr[b_y * width + x]) {
+            return false;
+        }
+
+        if(a._palette.at(a._style_ids._ptr[a_y * width + x]) != b._palette.at(b._style_ids._ptr[b_y * width + x])) {
+            return false;
+        }
+#endif
+    }
+
+    return true;
+}
+
+/**
+ * @brief the longest stretch of rows of back that are rows of front moved by shift and what scrolling it saves
+ **/
+static ScrollRun findScrollRun(
+    const uint64_t* const front_hashes,
+    const uint64_t* const back_hashes,
+    const uintmax_t height,
+    const intmax_t shift
+) {
+    const uintmax_t n = shift > 0 ? shift : -shift;
+
+    ScrollRun best = {._begin = 0, ._end = 0, ._shift = shift, ._gain = 0};
+
+    // back rows that have a front row shift away
+    const uintmax_t first = shift > 0 ? 0 : n;
+    const uintmax_t last = shift > 0 ? height - n : height;
+
+    uintmax_t y = first;
+
+    while(y < last) {
+        if(back_hashes[y] != front_hashes[y + shift]) {
+            y++;
+            continue;
+        }
+
+        const uintmax_t begin = y;
+
+        intmax_t gain = 0;
+
+        for(; y < last && back_hashes[y] == front_hashes[y + shift]; y++) {
+            gain += back_hashes[y] != front_hashes[y];
+        }
+
+        // the rows the scroll vacates have to be redrawn even if they were up to date
+        const uintmax_t vacated = shift > 0 ? y : begin - n;
+
+        for(uintmax_t v = vacated; v < vacated + n; v++) {
+            gain -= back_hashes[v] == front_hashes[v];
+        }
+
+        if(gain > best._gain) {
+            best = {._begin = begin, ._end = y - 1, ._shift = shift, ._gain = gain};
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief finds rows of back that are rows of front moved up or down and scrolls the terminal to match
+ * front is shifted the same way and the rows the scroll blanked are marked dirty in back, a diff against front after this only sends what the scroll did not
+ * the scroll region spans whole terminal rows, so back has to be as wide as the terminal
+ **/
+static Out::FlushStatus submitScrollDiff(
+    Array<uint8_t>& out_buf,
+    Array<Out::Instruction>& instr_buf,
+    Codegen::State& state,
+    StyledBuffer& front,
+    StyledBuffer& back,
+    const uintmax_t fd
+) {
+    assert(front.box() == back.box());
+
+    const uintmax_t width = back.box()._width;
+    const uintmax_t height = back.box()._height;
+
+    if(height < SCROLL_MIN_ROW_C + 1 || (state._columns != 0 && state._columns != width)) {
+        return Out::FlushStatus::Done;
+    }
+
+    {
+        uintmax_t dirty_c = 0;
+
+        for(uintmax_t y = back._dirty.nextDirty(0); y < height && dirty_c < SCROLL_MIN_ROW_C; y = back._dirty.nextDirty(y + 1)) {
+            dirty_c++;
+        }
+
+        if(dirty_c < SCROLL_MIN_ROW_C) {
+            return Out::FlushStatus::Done;
+        }
+    }
+
+    Arena& scratch = state._scratch;
+
+    uint64_t* const front_hashes = scratch.push<uint64_t>(height);
+    uint64_t* const back_hashes = scratch.push<uint64_t>(height);
+
+    // front's hashes are mostly cached from earlier frames, only the rows written since are hashed
+    for(uintmax_t y = 0; y < height; y++) {
+        front_hashes[y] = front.rowHash(y);
+    }
+
+    for(uintmax_t y = 0; y < height; y++) {
+        back_hashes[y] = back._dirty.isDirty(y) ? back.rowHash(y) : front_hashes[y];
+    }
+
+    uintmax_t slot_c = 16;
+
+    while(slot_c < height * 2) {
+        slot_c *= 2;
+    }
+
+    ScrollSlot* const slots = scratch.push<ScrollSlot>(slot_c);
+
+    memset(slots, 0, slot_c * sizeof(ScrollSlot));
+
+    for(uintmax_t y = 0; y < height; y++) {
+        uintmax_t i = front_hashes[y] & (slot_c - 1);
+
+        while(slots[i]._row != 0 && slots[i]._hash != front_hashes[y]) {
+            i = (i + 1) & (slot_c - 1);
+        }
+
+        slots[i] = {._hash = front_hashes[y], ._row = slots[i]._row == 0 ? y + 1 : SCROLL_ROW_REPEATED};
+    }
+
+    // every changed row that is found elsewhere in front proposes the shift that brought it there
+    intmax_t shifts[SCROLL_CANDIDATE_C];
+    uintmax_t shift_c = 0;
+
+    for(uintmax_t y = back._dirty.nextDirty(0); y < height; y = back._dirty.nextDirty(y + 1)) {
+        if(back_hashes[y] == front_hashes[y]) {
+            continue;
+        }
+
+        uintmax_t i = back_hashes[y] & (slot_c - 1);
+
+        while(slots[i]._row != 0 && slots[i]._hash != back_hashes[y]) {
+            i = (i + 1) & (slot_c - 1);
+        }
+
+        if(slots[i]._row == 0 || slots[i]._row == SCROLL_ROW_REPEATED) {
+            continue;
+        }
+
+        const intmax_t shift = static_cast<intmax_t>(slots[i]._row - 1) - static_cast<intmax_t>(y);
+
+        bool known = false;
+
+        for(uintmax_t c = 0; c < shift_c; c++) {
+            known |= shifts[c] == shift;
+        }
+
+        if(!known && shift_c < SCROLL_CANDIDATE_C) {
+            shifts[shift_c++] = shift;
+        }
+    }
+
+    ScrollRun best = {._begin = 0, ._end = 0, ._shift = 0, ._gain = 0};
+
+    for(uintmax_t c = 0; c < shift_c; c++) {
+        const ScrollRun run = findScrollRun(front_hashes, back_hashes, height, shifts[c]);
+
+        if(run._gain > best._gain) {
+            best = run;
+        }
+    }
+
+    scratch.reset();
+
+    if(best._gain < static_cast<intmax_t>(SCROLL_MIN_ROW_C)) {
+        return Out::FlushStatus::Done;
+    }
+
+    // equal hashes are not proof
+    for(uintmax_t y = best._begin; y <= best._end; y++) {
+        if(!rowsEqual(back, y, front, y + best._shift)) {
+            return Out::FlushStatus::Done;
+        }
+    }
+
+    const bool up = best._shift > 0;
+    const uintmax_t n = up ? best._shift : -best._shift;
+    const uintmax_t moved_c = best._end - best._begin + 1;
+
+    // the rows the scroll blanks, they follow the moved rows when scrolling up and precede them when scrolling down
+    const uintmax_t vacated = up ? best._end + 1 : best._begin - n;
+
+    const Out::FlushStatus status = Codegen::submitInstruction(out_buf, instr_buf, state, Codegen::Instruction::createScroll({
+        ._top = up ? best._begin : vacated,
+        ._bottom = up ? best._end + n : best._end,
+        ._n = n,
+        ._up = up
+    }), fd);
+
+    front.moveRows(best._begin + best._shift, best._begin, moved_c);
+    front.clearRows(vacated, n);
+
+    for(uintmax_t y = vacated; y < vacated + n; y++) {
+        back.markDirty(Position::create(0, y), width);
+    }
+
+    return status;
+}
+
+}
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace Tesix {
+
+struct ArenaBlock {
+    ArenaBlock* _next;
+    uintmax_t _cap;
+};
+
+/**
+ * @brief bump allocator for memory that only lives until the next reset()
+ * allocations that do not fit are served from overflow blocks, reset() then grows the main block so the same workload fits
+ * without touching malloc again
+ **/
+struct Arena {
+    uint8_t* _ptr;
+    uintmax_t _cap;
+    uintmax_t _n;
+
+    ArenaBlock* _overflow;
+    uintmax_t _overflow_n;
+
+    static inline Arena init() {
+        return {._ptr = nullptr, ._cap = 0, ._n = 0, ._overflow = nullptr, ._overflow_n = 0};
+    }
+
+    static inline Arena alloc(
+        const uintmax_t cap
+    ) {
+        return {._ptr = static_cast<uint8_t*>(malloc(cap)), ._cap = cap, ._n = 0, ._overflow = nullptr, ._overflow_n = 0};
+    }
+
+    inline void free() {
+        freeOverflow();
+
+        ::free(_ptr);
+
+        _ptr = nullptr;
+        _cap = 0;
+        _n = 0;
+    }
+
+    template<typename T>
+    inline T* push(
+        const uintmax_t n
+    ) {
+        return static_cast<T*>(pushBytes(sizeof(T) * n, alignof(T)));
+    }
+
+    void* pushBytes(
+        const uintmax_t size,
+        const uintmax_t align
+    ) {
+        assert(align > 0 && (align & (align - 1)) == 0);
+
+        const uintmax_t start = (_n + align - 1) & ~(align - 1);
+
+        if(start + size <= _cap) {
+            _n = start + size;
+
+            return _ptr + start;
+        }
+
+        return pushOverflow(size, align);
+    }
+
+    inline void reset() {
+        if(_overflow != nullptr) {
+            const uintmax_t needed = _n + _overflow_n;
+
+            freeOverflow();
+
+            uintmax_t cap = _cap > 0 ? _cap : 256;
+
+            while(cap < needed) {
+                cap *= 2;
+            }
+
+            ::free(_ptr);
+
+            _ptr = static_cast<uint8_t*>(malloc(cap));
+            _cap = cap;
+        }
+
+        _n = 0;
+    }
+
+    void* pushOverflow(
+        const uintmax_t size,
+        const uintmax_t align
+    ) {
+        const uintmax_t header = (sizeof(ArenaBlock) + align - 1) & ~(align - 1);
+
+        ArenaBlock* const block = static_cast<ArenaBlock*>(malloc(header + size));
+
+        block->_next = _overflow;
+        block->_cap = size;
+
+        _overflow = block;
+        _overflow_n += size + align;
+
+        return reinterpret_cast<uint8_t*>(block) + header;
+    }
+
+    inline void freeOverflow() {
+        ArenaBlock* cur = _overflow;
+
+        while(cur != nullptr) {
+            ArenaBlock* const next = cur->_next;
+
+            ::free(cur);
+
+            cur = next;
+        }
+
+        _overflow = nullptr;
+        _overflow_n = 0;
+    }
+};
+
+}
@@ -60,6 +60,17 @@ struct Array {
         ::free(_ptr);
     }
 
+    inline void reserve(
+        const uintmax_t cap
+    ) {
+        if(cap <= _cap) {
+            return;
+        }
+
+        _ptr = (T*)(realloc(_ptr, sizeof(T) * cap));
+        _cap = cap;
+    }
+
     inline uintmax_t remaining() const {
         return _cap - _n;
     }
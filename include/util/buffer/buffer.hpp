@@ -38,6 +38,19 @@ struct Buffer {
         };
     }
 
+    static inline Buffer<T> initZeroed(
+        const size_t width,
+        const size_t height
+    ) {
+        return {
+            ._ptr = static_cast<T*>(calloc(width * height, sizeof(T))),
+            ._box = {
+                ._width = width,
+                ._height = height
+            }
+        };
+    }
+
     inline size_t index(
         const Position& pos
     ) const {
@@ -97,7 +110,7 @@ struct BufferArea {
         const Position& pos
     ) {
         assert(_parent != nullptr);
-        assert(pos.isInside(_area));
+        assert(pos.isInside(_area._box));
 
         return _parent->at(pos + _area._pos);
     }
@@ -106,7 +119,7 @@ struct BufferArea {
         const Position& pos
     ) const {
         assert(_parent != nullptr);
-        assert(pos.isInside(_area));
+        assert(pos.isInside(_area._box));
 
         return _parent->at(pos + _area._pos);
     }
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace Tesix {
+
+// columns [_begin, _end) of a row that were written, empty when _begin >= _end
+struct DirtySpan {
+    uintmax_t _begin;
+    uintmax_t _end;
+};
+
+/**
+ * @brief records which rows of a buffer were written since the last clear() and which columns of them
+ * the bitmap lets renderers skip clean rows 64 at a time, the spans narrow the work inside a dirty row
+ * it also tracks which rows still match the hash their buffer cached for them, a write invalidates it whether or not the row was dirty already
+ **/
+struct DirtyRows {
+    DirtySpan* _spans = nullptr;
+    uint64_t* _bitmap = nullptr;
+
+    // rows whose cached hash is current, clear() leaves it alone
+    uint64_t* _hashed = nullptr;
+
+    uintmax_t _height;
+
+    ~DirtyRows() {
+        ::free(_spans);
+        ::free(_bitmap);
+        ::free(_hashed);
+    }
+
+    static inline DirtyRows init(
+        const uintmax_t height
+    ) {
+        return {
+            ._spans = static_cast<DirtySpan*>(calloc(height, sizeof(DirtySpan))),
+            ._bitmap = static_cast<uint64_t*>(calloc((height + 63) / 64, sizeof(uint64_t))),
+            ._hashed = static_cast<uint64_t*>(calloc((height + 63) / 64, sizeof(uint64_t))),
+            ._height = height
+        };
+    }
+
+    inline void mark(
+        const uintmax_t y,
+        const uintmax_t begin,
+        const uintmax_t end
+    ) {
+        assert(y < _height);
+        assert(begin < end);
+
+        _hashed[y / 64] &= ~(uint64_t(1) << (y % 64));
+
+        DirtySpan& span = _spans[y];
+
+        if(span._begin >= span._end) {
+            span = {._begin = begin, ._end = end};
+
+            _bitmap[y / 64] |= uint64_t(1) << (y % 64);
+            return;
+        }
+
+        if(begin < span._begin) {
+            span._begin = begin;
+        }
+
+        if(end > span._end) {
+            span._end = end;
+        }
+    }
+
+    inline void markAll(
+        const uintmax_t width
+    ) {
+        for(uintmax_t y = 0; y < _height; y++) {
+            _spans[y] = {._begin = 0, ._end = width};
+        }
+
+        for(uintmax_t i = 0; i < (_height + 63) / 64; i++) {
+            _bitmap[i] = ~uint64_t(0);
+            _hashed[i] = 0;
+        }
+    }
+
+    /**
+     * @brief forgets the writes to row y, for rows that turned out to hold what they held before
+     **/
+    inline void unmark(
+        const uintmax_t y
+    ) {
+        assert(y < _height);
+
+        _spans[y] = {._begin = 0, ._end = 0};
+        _bitmap[y / 64] &= ~(uint64_t(1) << (y % 64));
+    }
+
+    inline bool isHashed(
+        const uintmax_t y
+    ) const {
+        assert(y < _height);
+
+        return (_hashed[y / 64] >> (y % 64)) & 1;
+    }
+
+    inline void setHashed(
+        const uintmax_t y,
+        const bool hashed
+    ) {
+        assert(y < _height);
+
+        if(hashed) {
+            _hashed[y / 64] |= uint64_t(1) << (y % 64);
+        } else {
+            _hashed[y / 64] &= ~(uint64_t(1) << (y % 64));
+        }
+    }
+
+    inline bool isDirty(
+        const uintmax_t y
+    ) const {
+        assert(y < _height);
+
+        return (_bitmap[y / 64] >> (y % 64)) & 1;
+    }
+
+    /**
+     * @brief first dirty row at or after y, _height if there is none
+     **/
+    inline uintmax_t nextDirty(
+        const uintmax_t y
+    ) const {
+        if(y >= _height) {
+            return _height;
+        }
+
+        uintmax_t word_i = y / 64;
+        uint64_t word = _bitmap[word_i] & (~uint64_t(0) << (y % 64));
+
+        while(word == 0) {
+            word_i++;
+
+            if(word_i >= (_height + 63) / 64) {
+                return _height;
+            }
+
+            word = _bitmap[word_i];
+        }
+
+        const uintmax_t next = word_i * 64 + __builtin_ctzll(word);
+
+        return next < _height ? next : _height;
+    }
+
+    inline void clear() {
+        for(uintmax_t y = nextDirty(0); y < _height; y = nextDirty(y + 1)) {
+            _spans[y] = {._begin = 0, ._end = 0};
+        }
+
+        for(uintmax_t i = 0; i < (_height + 63) / 64; i++) {
+            _bitmap[i] = 0;
+        }
+    }
+};
+
+}
@@ -12,14 +12,39 @@ namespace Tesix {
 
 namespace Draw {
 
+#if defined(TESIX_PACKED_CELLS)
+// codepoints storeString() decodes at a time into the stack before spreading them over packed cells
+constexpr uintmax_t STRING_CHUNK_C = 64;
+#endif
+
+// stores a cell without marking it dirty, callers mark whole spans at once
+static inline void storeCharacter(
+    StyledBuffer& buf,
+    const uint32_t ch,
+    const Style::StyleContainer& style,
+    const Position& pos
+) {
+    buf.set(pos, ch, style);
+}
+
+static inline void storeCharacter(
+    StyledBufferArea& buf,
+    const uint32_t ch,
+    const Style::StyleContainer& style,
+    const Position& pos
+) {
+    buf.set(pos, ch, style);
+}
+
 static void drawCharacter(
     StyledBuffer& buf,
     const uint32_t ch,
     const Style::StyleContainer& style,
     const Position& pos
 ) {
-    buf._ch.at(pos) = ch;
-    buf._style.at(pos) = style;
+    storeCharacter(buf, ch, style, pos);
+
+    buf.markDirty(pos, 1);
 }
 
 static void drawCharacter(
@@ -28,8 +53,9 @@ static void drawCharacter(
     const Style::StyleContainer& style,
     const Position& pos
 ) {
-    buf._ch.at(pos) = ch;
-    buf._style.at(pos) = style;
+    storeCharacter(buf, ch, style, pos);
+
+    buf.markDirty(pos, 1);
 }
 
 static void drawCharacter(
@@ -38,55 +64,108 @@ static void drawCharacter(
     const Style::StyleContainer& style,
     const Position& pos
 ) {
-    buf._ch.at(pos) = ch;
-    buf._style.at(pos) = style;
+    storeCharacter(buf, ch, style, pos);
+
+    buf.markDirty(pos, 1);
 }
 
-static void drawString(
-    StyledBuffer& buf,
+/**
+ * @brief decodes utf8 straight into the row at pos, the text is clipped at the right edge of buf
+ * malformed UTF-8 is drawn as U+FFFD and counted in decoder
+ * @return the amount of cells written
+ **/
+static uintmax_t storeString(
+    StyledBufferArea& buf,
     const uint8_t* const utf8,
     const uintmax_t utf8_c,
     const Style::StyleContainer& style,
-    const Position& pos
+    const Position& pos,
+    UTF8::Decoder& decoder
 ) {
-    auto utf32 = UTF8::toUTF32(utf8, utf8_c);
+    if(pos._x >= buf.box()._width || pos._y >= buf.box()._height) {
+        return 0;
+    }
+
+    const uintmax_t room = buf.box()._width - pos._x;
+
+#if defined(TESIX_PACKED_CELLS)
+    // the codepoints are interleaved with styles, so they are decoded in chunks and spread over the cells
+    Cell* const cells = &buf._cells.at(pos);
+    const uint64_t value = style.value();
+
+    uint32_t chunk[STRING_CHUNK_C];
+    uintmax_t cell_c = 0;
+
+    while(cell_c < room) {
+        const uintmax_t cap = room - cell_c < STRING_CHUNK_C ? room - cell_c : STRING_CHUNK_C;
+        const uintmax_t n = UTF8::decodeInto(chunk, cap, utf8, utf8_c, decoder);
+
+        if(n == 0) {
+            break;
+        }
+
+        for(uintmax_t i = 0; i < n; i++) {
+            cells[cell_c + i] = {._ch = chunk[i], ._style = value};
+        }
 
-    for(uintmax_t i = 0; i < utf32._n; i++) {
-        drawCharacter(buf, utf32._ptr[i], style, pos + Position::create(i, 0));
+        cell_c += n;
     }
 
-    utf32.free();
+    return cell_c;
+#else
+    // interning first, it may renumber the ids already in the buffer
+    const uint16_t id = buf._palette->intern(style.value(), *buf._style_ids._parent);
+
+    const uintmax_t cell_c = UTF8::decodeInto(&buf._ch.at(pos), room, utf8, utf8_c, decoder);
+
+    uint16_t* const ids = &buf._style_ids.at(pos);
+
+    for(uintmax_t i = 0; i < cell_c; i++) {
+        ids[i] = id;
+    }
+
+    return cell_c;
+#endif
 }
 
-static void drawString(
+/**
+ * @brief returns the amount of malformed UTF-8 sequences among what was drawn, they show as U+FFFD
+ **/
+static uintmax_t drawString(
     StyledBufferArea& buf,
     const uint8_t* const utf8,
     const uintmax_t utf8_c,
     const Style::StyleContainer& style,
     const Position& pos
 ) {
-    auto utf32 = UTF8::toUTF32(utf8, utf8_c);
+    UTF8::Decoder decoder = {._cur = 0, ._invalid_c = 0};
 
-    for(uintmax_t i = 0; i < utf32._n; i++) {
-        drawCharacter(buf, utf32._ptr[i], style, pos + Position::create(i, 0));
-    }
+    const uintmax_t cell_c = storeString(buf, utf8, utf8_c, style, pos, decoder);
 
-    utf32.free();
+    buf.markDirty(pos, cell_c);
+
+    return decoder._invalid_c;
 }
 
-static void drawString(
-    StyledBufferArea&& buf,
-    const char* const utf8,
+static uintmax_t drawString(
+    StyledBuffer& buf,
+    const uint8_t* const utf8,
+    const uintmax_t utf8_c,
     const Style::StyleContainer& style,
     const Position& pos
 ) {
-    auto utf32 = UTF8::toUTF32(asByteStr(utf8), strlen(utf8));
+    StyledBufferArea all = buf.all();
 
-    for(uintmax_t i = 0; i < utf32._n; i++) {
-        drawCharacter(buf, utf32._ptr[i], style, pos + Position::create(i, 0));
-    }
+    return drawString(all, utf8, utf8_c, style, pos);
+}
 
-    utf32.free();
+static uintmax_t drawString(
+    StyledBufferArea&& buf,
+    const char* const utf8,
+    const Style::StyleContainer& style,
+    const Position& pos
+) {
+    return drawString(buf, asByteStr(utf8), strlen(utf8), style, pos);
 }
 
 static void fill(
@@ -94,10 +173,12 @@ static void fill(
     const uint32_t ch,
     const Style::StyleContainer& style
 ) {
-    for(uintmax_t y = 0; y < buf._ch._box._height; y++) {
-        for(uintmax_t x = 0; x < buf._ch._box._width; x++) {
-            drawCharacter(buf, ch, style, Position::create(x, y));
+    for(uintmax_t y = 0; y < buf.box()._height; y++) {
+        for(uintmax_t x = 0; x < buf.box()._width; x++) {
+            storeCharacter(buf, ch, style, Position::create(x, y));
         }
+
+        buf.markDirty(Position::create(0, y), buf.box()._width);
     }
 }
 
@@ -106,10 +187,12 @@ static void fill(
     const uint32_t ch,
     const Style::StyleContainer& style
 ) {
-    for(uintmax_t y = 0; y < buf._ch._area._box._height; y++) {
-        for(uintmax_t x = 0; x < buf._ch._area._box._width; x++) {
-            drawCharacter(buf, ch, style, Position::create(x, y));
+    for(uintmax_t y = 0; y < buf.box()._height; y++) {
+        for(uintmax_t x = 0; x < buf.box()._width; x++) {
+            storeCharacter(buf, ch, style, Position::create(x, y));
         }
+
+        buf.markDirty(Position::create(0, y), buf.box()._width);
     }
 }
 
@@ -118,13 +201,30 @@ static void fill(
     const uint32_t ch,
     const Style::StyleContainer& style
 ) {
-    for(uintmax_t y = 0; y < buf._ch._area._box._height; y++) {
-        for(uintmax_t x = 0; x < buf._ch._area._box._width; x++) {
-            drawCharacter(buf, ch, style, Position::create(x, y));
+    for(uintmax_t y = 0; y < buf.box()._height; y++) {
+        for(uintmax_t x = 0; x < buf.box()._width; x++) {
+            storeCharacter(buf, ch, style, Position::create(x, y));
         }
+
+        buf.markDirty(Position::create(0, y), buf.box()._width);
     }
 }
 
+static void drawBuffer(
+    StyledBuffer& buf,
+    const StyledBufferArea& src,
+    const Position& pos
+) {
+    for(uintmax_t y = 0; y < src.box()._height; y++) {
+        for(uintmax_t x = 0; x < src.box()._width; x++) {
+            const Position src_pos = Position::create(x, y);
+
+            storeCharacter(buf, src.ch(src_pos), src.style(src_pos), pos + src_pos);
+        }
+
+        buf.markDirty(pos + Position::create(0, y), src.box()._width);
+    }
+}
 
 }
 
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "util/buffer/buffer.hpp"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace Tesix {
+
+constexpr uintmax_t STYLE_PALETTE_MAX_C = UINT16_MAX;
+
+static inline uint64_t nextStylePaletteId() {
+    static uint64_t id = 0;
+
+    return __atomic_add_fetch(&id, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief interns encoded styles into 16 bit ids, equal ids mean equal styles
+ * palettes with the same _id agree on every id both of them know, so their cells can be compared by id
+ * the hash index is built lazily, a palette that is only mirrored into never pays for it
+ * a full palette drops the styles no cell uses anymore, more distinct styles in use than ids is fatal like a failed allocation
+ **/
+struct StylePalette {
+    uint64_t* _styles = nullptr;
+    uintmax_t _cap;
+    uintmax_t _n;
+
+    // open addressed, holds id + 1 so 0 marks an empty slot
+    uint16_t* _slots = nullptr;
+    uintmax_t _slot_cap;
+    uintmax_t _indexed_n;
+
+    // the last interned id, runs of equal styles skip the hash
+    uint16_t _last_id;
+
+    uint64_t _id;
+
+    // scratch for compact(), allocated by the first compaction and kept
+    uint16_t* _remap = nullptr;
+
+    ~StylePalette() {
+        ::free(_styles);
+        ::free(_slots);
+        ::free(_remap);
+    }
+
+    // id 0 is the default style so zeroed cells are valid
+    static inline StylePalette init() {
+        uint64_t* const styles = static_cast<uint64_t*>(malloc(16 * sizeof(uint64_t)));
+
+        styles[0] = 0;
+
+        return {
+            ._styles = styles,
+            ._cap = 16,
+            ._n = 1,
+            ._slots = nullptr,
+            ._slot_cap = 0,
+            ._indexed_n = 0,
+            ._last_id = 0,
+            ._id = nextStylePaletteId(),
+            ._remap = nullptr
+        };
+    }
+
+    inline uint64_t at(
+        const uint16_t id
+    ) const {
+        assert(id < _n);
+
+        return _styles[id];
+    }
+
+    static inline uintmax_t hash(
+        const uint64_t style
+    ) {
+        uint64_t h = style * 0x9e3779b97f4a7c15;
+
+        return h ^ (h >> 29);
+    }
+
+    /**
+     * @brief id of style, adding it if it is new
+     * when the palette is full the ids no cell of ids refers to are dropped and ids is renumbered
+     * every full palette compacts, cells overwritten since the last compaction free their ids right away
+     **/
+    uint16_t intern(
+        const uint64_t style,
+        Buffer<uint16_t>& ids
+    ) {
+        if(_styles[_last_id] == style) {
+            return _last_id;
+        }
+
+        index();
+
+        uintmax_t slot = hash(style) & (_slot_cap - 1);
+
+        while(_slots[slot] != 0) {
+            const uint16_t id = _slots[slot] - 1;
+
+            if(_styles[id] == style) {
+                _last_id = id;
+
+                return id;
+            }
+
+            slot = (slot + 1) & (_slot_cap - 1);
+        }
+
+        if(_n == STYLE_PALETTE_MAX_C) {
+            compact(ids);
+
+            // any id handed out now would show some other style
+            assert(_n < STYLE_PALETTE_MAX_C);
+            if(_n == STYLE_PALETTE_MAX_C) exit(1);
+
+            return intern(style, ids);
+        }
+
+        if(_n == _cap) {
+            _cap = _cap > 0 ? _cap * 2 : 16;
+            _styles = static_cast<uint64_t*>(realloc(_styles, _cap * sizeof(uint64_t)));
+        }
+
+        const uint16_t id = _n;
+
+        _styles[id] = style;
+        _n += 1;
+
+        _slots[slot] = id + 1;
+        _indexed_n = _n;
+
+        _last_id = id;
+
+        return id;
+    }
+
+    /**
+     * @brief makes sure every style is in the hash index and the index stays at most half full
+     **/
+    inline void index() {
+        if(_indexed_n == _n && _n < _slot_cap / 2) {
+            return;
+        }
+
+        uintmax_t slot_cap = _slot_cap > 0 ? _slot_cap : 32;
+
+        while(slot_cap / 2 <= _n) {
+            slot_cap *= 2;
+        }
+
+        if(slot_cap != _slot_cap) {
+            ::free(_slots);
+
+            _slots = static_cast<uint16_t*>(malloc(slot_cap * sizeof(uint16_t)));
+            _slot_cap = slot_cap;
+            _indexed_n = 0;
+        }
+
+        if(_indexed_n == 0) {
+            memset(_slots, 0, _slot_cap * sizeof(uint16_t));
+        }
+
+        for(uintmax_t id = _indexed_n; id < _n; id++) {
+            uintmax_t slot = hash(_styles[id]) & (_slot_cap - 1);
+
+            while(_slots[slot] != 0) {
+                slot = (slot + 1) & (_slot_cap - 1);
+            }
+
+            _slots[slot] = id + 1;
+        }
+
+        _indexed_n = _n;
+    }
+
+    /**
+     * @brief drops every style no cell uses and renumbers the cells, starts a new _id
+     **/
+    void compact(
+        Buffer<uint16_t>& ids
+    ) {
+        if(_remap == nullptr) {
+            _remap = static_cast<uint16_t*>(malloc((STYLE_PALETTE_MAX_C + 1) * sizeof(uint16_t)));
+        }
+
+        uint16_t* const remap = _remap;
+
+        memset(remap, 0xff, (STYLE_PALETTE_MAX_C + 1) * sizeof(uint16_t));
+
+        const uintmax_t cell_c = ids._box.size();
+
+        // the default style keeps id 0
+        remap[0] = 0;
+
+        for(uintmax_t i = 0; i < cell_c; i++) {
+            remap[ids._ptr[i]] = 0;
+        }
+
+        uintmax_t n = 0;
+
+        for(uintmax_t id = 0; id < _n; id++) {
+            if(remap[id] == 0) {
+                remap[id] = n;
+                _styles[n] = _styles[id];
+                n++;
+            }
+        }
+
+        for(uintmax_t i = 0; i < cell_c; i++) {
+            ids._ptr[i] = remap[ids._ptr[i]];
+        }
+
+        _n = n;
+        _indexed_n = 0;
+        _last_id = 0;
+        _id = nextStylePaletteId();
+
+        index();
+    }
+
+    /**
+     * @brief makes this palette agree with src on every id, only copies what src added since the last mirror
+     **/
+    void mirror(
+        const StylePalette& src
+    ) {
+        if(_id == src._id && _n == src._n) {
+            return;
+        }
+
+        if(_cap < src._n) {
+            _cap = src._cap;
+            _styles = static_cast<uint64_t*>(realloc(_styles, _cap * sizeof(uint64_t)));
+        }
+
+        const uintmax_t from = _id == src._id && _n <= src._n ? _n : 0;
+
+        memcpy(_styles + from, src._styles + from, (src._n - from) * sizeof(uint64_t));
+
+        if(from == 0) {
+            _indexed_n = 0;
+        }
+
+        _n = src._n;
+        _last_id = 0;
+        _id = src._id;
+    }
+};
+
+}
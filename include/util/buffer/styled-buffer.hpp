@@ -1,44 +1,458 @@
 #pragma once
 
+#include "util/arena.hpp"
 #include "util/buffer.hpp"
+#include "util/buffer/dirty.hpp"
+#include "util/buffer/style-palette.hpp"
+#include "util/run.hpp"
 
 #include <stdint.h>
+#include <string.h>
 
 namespace Tesix {
 
+#if defined(TESIX_PACKED_CELLS)
+
+/**
+ * @brief codepoint and encoded style of a cell side by side, a row scan reads one stream instead of two
+ * styles are stored by value, a StyleContainer::createPtr() style is resolved when the cell is written
+ **/
+struct Cell {
+    uint32_t _ch;
+    uint64_t _style;
+};
+
+// compares two cells' styles within one buffer
+using StyleKey = uint64_t;
+
+#else
+
+using StyleKey = uint16_t;
+
+#endif
+
 struct StyledBufferArea {
+#if defined(TESIX_PACKED_CELLS)
+    BufferArea<Cell> _cells;
+#else
     BufferArea<uint32_t> _ch;
-    BufferArea<Style::StyleContainer> _style;
+    BufferArea<uint16_t> _style_ids;
+
+    StylePalette* _palette;
+#endif
+
+    // dirty rows of the parent buffer, nullptr if writes are not tracked
+    DirtyRows* _dirty;
 
     inline StyledBufferArea area(
         const FloatingBox& area
     ) {
-        return {._ch = _ch.area(area), ._style = _style.area(area)};
+#if defined(TESIX_PACKED_CELLS)
+        return {._cells = _cells.area(area), ._dirty = _dirty};
+#else
+        return {._ch = _ch.area(area), ._style_ids = _style_ids.area(area), ._palette = _palette, ._dirty = _dirty};
+#endif
+    }
+
+    inline const FloatingBox& bounds() const {
+#if defined(TESIX_PACKED_CELLS)
+        return _cells._area;
+#else
+        return _ch._area;
+#endif
+    }
+
+    inline const Box& box() const {
+        return bounds()._box;
+    }
+
+    inline uint32_t ch(
+        const Position& pos
+    ) const {
+#if defined(TESIX_PACKED_CELLS)
+        return _cells.at(pos)._ch;
+#else
+        return _ch.at(pos);
+#endif
+    }
+
+    inline Style::StyleContainer style(
+        const Position& pos
+    ) const {
+#if defined(TESIX_PACKED_CELLS)
+        return Style::StyleContainer::createValue(_cells.at(pos)._style);
+#else
+        return Style::StyleContainer::createValue(_palette->at(_style_ids.at(pos)));
+#endif
+    }
+
+    inline uint64_t styleValue(
+        const Position& pos
+    ) const {
+#if defined(TESIX_PACKED_CELLS)
+        return _cells.at(pos)._style;
+#else
+        return _palette->at(_style_ids.at(pos));
+#endif
+    }
+
+    /**
+     * @brief equal keys mean equal styles, only comparable between cells of the same area
+     **/
+    inline StyleKey styleKey(
+        const Position& pos
+    ) const {
+#if defined(TESIX_PACKED_CELLS)
+        return _cells.at(pos)._style;
+#else
+        return _style_ids.at(pos);
+#endif
+    }
+
+    /**
+     * @brief amount of cells starting at pos that share its style, at most len, the run stays within a row
+     **/
+    inline uintmax_t styleRun(
+        const Position& pos,
+        const uintmax_t len
+    ) const {
+        assert(pos._x + len <= box()._width);
+
+#if defined(TESIX_PACKED_CELLS)
+        const Cell* const cells = &_cells.at(pos);
+
+        for(uintmax_t i = 1; i < len; i++) {
+            if(cells[i]._style != cells[0]._style) {
+                return i;
+            }
+        }
+
+        return len;
+#else
+        return runLength(&_style_ids.at(pos), len);
+#endif
+    }
+
+    /**
+     * @brief true if styleKey() of this area can be compared with other's
+     **/
+    inline bool sharesStyleKeys(
+        const StyledBufferArea& other
+    ) const {
+#if defined(TESIX_PACKED_CELLS)
+        return true;
+#else
+        return _palette->_id == other._palette->_id;
+#endif
+    }
+
+    /**
+     * @brief len consecutive codepoints starting at pos
+     * the packed layout gathers them into scratch, so the result lives until the arena is reset
+     **/
+    inline const uint32_t* chars(
+        const Position& pos,
+        const uintmax_t len,
+        Arena& scratch
+    ) const {
+#if defined(TESIX_PACKED_CELLS)
+        uint32_t* const str = scratch.push<uint32_t>(len);
+
+        const Cell* const cells = &_cells.at(pos);
+
+        for(uintmax_t i = 0; i < len; i++) {
+            str[i] = cells[i]._ch;
+        }
+
+        return str;
+#else
+        return &_ch.at(pos);
+#endif
+    }
+
+    inline void set(
+        const Position& pos,
+        const uint32_t ch,
+        const Style::StyleContainer& style
+    ) {
+#if defined(TESIX_PACKED_CELLS)
+        _cells.at(pos) = {._ch = ch, ._style = style.value()};
+#else
+        _ch.at(pos) = ch;
+        _style_ids.at(pos) = _palette->intern(style.value(), *_style_ids._parent);
+#endif
+    }
+
+    /**
+     * @brief records that len cells starting at pos (relative to the area) were written
+     **/
+    inline void markDirty(
+        const Position& pos,
+        const uintmax_t len
+    ) {
+        if(_dirty == nullptr || len == 0) {
+            return;
+        }
+
+        const Position& origin = bounds()._pos;
+
+        _dirty->mark(origin._y + pos._y, origin._x + pos._x, origin._x + pos._x + len);
     }
 };
 
+/**
+ * @brief multiply then xorshift, the shift carries the high bits the multiply produced down so the next multiply spreads them again
+ * a multiply alone only moves bits up, two flips of the same high style bit could cancel
+ **/
+static inline uint64_t mixRowHash(
+    const uint64_t h,
+    const uint64_t value
+) {
+    const uint64_t m = (h ^ value) * 0x9e3779b97f4a7c15;
+
+    return m ^ (m >> 32);
+}
+
 struct StyledBuffer {
+#if defined(TESIX_PACKED_CELLS)
+    Buffer<Cell> _cells;
+#else
     Buffer<uint32_t> _ch;
-    Buffer<Style::StyleContainer> _style;
+    Buffer<uint16_t> _style_ids;
+
+    StylePalette _palette;
+#endif
+
+    DirtyRows _dirty;
+
+    // one per row, current for the rows _dirty reports as hashed
+    Buffer<uint64_t> _row_hashes;
 
     static inline StyledBuffer init(
         const uintmax_t width,
         const uintmax_t height
     ) {
         return {
-            ._ch = Buffer<uint32_t>::init(width, height),
-            ._style = Buffer<Style::StyleContainer>::init(width, height)
+#if defined(TESIX_PACKED_CELLS)
+            ._cells = Buffer<Cell>::initZeroed(width, height),
+#else
+            ._ch = Buffer<uint32_t>::initZeroed(width, height),
+            ._style_ids = Buffer<uint16_t>::initZeroed(width, height),
+            ._palette = StylePalette::init(),
+#endif
+            ._dirty = DirtyRows::init(height),
+            ._row_hashes = Buffer<uint64_t>::init(1, height)
         };
     }
 
     inline StyledBufferArea area(
         const FloatingBox& area
     ) {
-        return {._ch = _ch.area(area), ._style = _style.area(area)};
+#if defined(TESIX_PACKED_CELLS)
+        return {._cells = _cells.area(area), ._dirty = &_dirty};
+#else
+        return {._ch = _ch.area(area), ._style_ids = _style_ids.area(area), ._palette = &_palette, ._dirty = &_dirty};
+#endif
     }
 
     inline StyledBufferArea all() {
-        return {._ch = _ch.all(), ._style = _style.all()};
+#if defined(TESIX_PACKED_CELLS)
+        return {._cells = _cells.all(), ._dirty = &_dirty};
+#else
+        return {._ch = _ch.all(), ._style_ids = _style_ids.all(), ._palette = &_palette, ._dirty = &_dirty};
+#endif
+    }
+
+    inline const Box& box() const {
+#if defined(TESIX_PACKED_CELLS)
+        return _cells._box;
+#else
+        return _ch._box;
+#endif
+    }
+
+    inline void set(
+        const Position& pos,
+        const uint32_t ch,
+        const Style::StyleContainer& style
+    ) {
+#if defined(TESIX_PACKED_CELLS)
+        _cells.at(pos) = {._ch = ch, ._style = style.value()};
+#else
+        _ch.at(pos) = ch;
+        _style_ids.at(pos) = _palette.intern(style.value(), _style_ids);
+#endif
+    }
+
+    inline bool sharesStyleKeys(
+        const StyledBuffer& other
+    ) const {
+#if defined(TESIX_PACKED_CELLS)
+        return true;
+#else
+        return _palette._id == other._palette._id;
+#endif
+    }
+
+    /**
+     * @brief copies len cells starting at pos from src, rows are contiguous so the span may cross rows
+     * the palette is mirrored from src so the copied style ids keep their meaning
+     **/
+    inline void copy(
+        const StyledBuffer& src,
+        const Position& pos,
+        const uintmax_t len
+    ) {
+        assert(box() == src.box());
+
+        const uintmax_t start = pos._y * box()._width + pos._x;
+
+        assert(start + len <= box().size());
+
+#if defined(TESIX_PACKED_CELLS)
+        memcpy(_cells._ptr + start, src._cells._ptr + start, len * sizeof(Cell));
+#else
+        _palette.mirror(src._palette);
+
+        memcpy(_ch._ptr + start, src._ch._ptr + start, len * sizeof(uint32_t));
+        memcpy(_style_ids._ptr + start, src._style_ids._ptr + start, len * sizeof(uint16_t));
+#endif
+
+        if(len == 0) {
+            return;
+        }
+
+        for(uintmax_t y = pos._y; y <= (start + len - 1) / box()._width; y++) {
+            _dirty.setHashed(y, false);
+        }
+    }
+
+    /**
+     * @brief hash of the codepoints and style values of row y, comparable between buffers whatever their palettes
+     **/
+    inline uint64_t hashRow(
+        const uintmax_t y
+    ) const {
+        const uintmax_t width = box()._width;
+        const uintmax_t start = y * width;
+
+        uint64_t h = width;
+
+        for(uintmax_t i = start; i < start + width; i++) {
+#if defined(TESIX_PACKED_CELLS)
+            h = mixRowHash(h, _cells._ptr[i]._ch);
+            h = mixRowHash(h, _cells._ptr[i]._style);
+#else
+            h = mixRowHash(h, _ch._ptr[i]);
+            h = mixRowHash(h, _palette.at(_style_ids._ptr[i]));
+#endif
+        }
+
+        return h ^ (h >> 32);
+    }
+
+    /**
+     * @brief hashRow(y), rehashed only if the row was written since the last call
+     * different hashes mean different rows, equal hashes still have to be confirmed by comparing the cells
+     **/
+    inline uint64_t rowHash(
+        const uintmax_t y
+    ) {
+        if(!_dirty.isHashed(y)) {
+            _row_hashes._ptr[y] = hashRow(y);
+            _dirty.setHashed(y, true);
+        }
+
+        return _row_hashes._ptr[y];
+    }
+
+    /**
+     * @brief takes over src's cached row hashes, only valid once every cell matches src
+     **/
+    inline void mirrorRowHashes(
+        const StyledBuffer& src
+    ) {
+        assert(box() == src.box());
+
+        const uintmax_t height = box()._height;
+
+        memcpy(_row_hashes._ptr, src._row_hashes._ptr, height * sizeof(uint64_t));
+        memcpy(_dirty._hashed, src._dirty._hashed, (height + 63) / 64 * sizeof(uint64_t));
+    }
+
+    /**
+     * @brief moves n rows starting at src_y to dst_y, the ranges may overlap
+     **/
+    inline void moveRows(
+        const uintmax_t src_y,
+        const uintmax_t dst_y,
+        const uintmax_t n
+    ) {
+        assert(src_y + n <= box()._height);
+        assert(dst_y + n <= box()._height);
+
+        const uintmax_t width = box()._width;
+
+#if defined(TESIX_PACKED_CELLS)
+        memmove(_cells._ptr + dst_y * width, _cells._ptr + src_y * width, n * width * sizeof(Cell));
+#else
+        memmove(_ch._ptr + dst_y * width, _ch._ptr + src_y * width, n * width * sizeof(uint32_t));
+        memmove(_style_ids._ptr + dst_y * width, _style_ids._ptr + src_y * width, n * width * sizeof(uint16_t));
+#endif
+
+        // the hashes move with their rows, walking away from the overlap
+        for(uintmax_t i = 0; i < n; i++) {
+            const uintmax_t row = dst_y < src_y ? i : n - 1 - i;
+
+            _row_hashes._ptr[dst_y + row] = _row_hashes._ptr[src_y + row];
+            _dirty.setHashed(dst_y + row, _dirty.isHashed(src_y + row));
+        }
+    }
+
+    /**
+     * @brief fills n rows starting at y with spaces in the default style
+     **/
+    inline void clearRows(
+        const uintmax_t y,
+        const uintmax_t n
+    ) {
+        assert(y + n <= box()._height);
+
+        const uintmax_t start = y * box()._width;
+        const uintmax_t len = n * box()._width;
+
+        for(uintmax_t i = start; i < start + len; i++) {
+#if defined(TESIX_PACKED_CELLS)
+            _cells._ptr[i] = {._ch = ' ', ._style = 0};
+#else
+            _ch._ptr[i] = ' ';
+#endif
+        }
+
+#if !defined(TESIX_PACKED_CELLS)
+        // id 0 is always the default style
+        memset(_style_ids._ptr + start, 0, len * sizeof(uint16_t));
+#endif
+
+        for(uintmax_t row = y; row < y + n; row++) {
+            _dirty.setHashed(row, false);
+        }
+    }
+
+    inline void markDirty(
+        const Position& pos,
+        const uintmax_t len
+    ) {
+        if(len == 0) {
+            return;
+        }
+
+        _dirty.mark(pos._y, pos._x, pos._x + len);
+    }
+
+    // for writes that bypass Draw::
+    inline void markAllDirty() {
+        _dirty.markAll(box()._width);
     }
 };
 
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Tesix {
+
+/**
+ * @brief length of the run of values equal to values[0], at most n
+ * uniform rows are compared 32 values (AVX2) or 8 values (SSE2) at a time, the tail is scalar
+ **/
+static inline uintmax_t runLength(
+    const uint16_t* const values,
+    const uintmax_t n
+) {
+    const uint16_t value = values[0];
+
+    uintmax_t i = 1;
+
+#if defined(__AVX2__)
+    const __m256i needle256 = _mm256_set1_epi16(value);
+
+    for(; i + 32 <= n; i += 32) {
+        const __m256i a = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), needle256);
+        const __m256i b = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 16)), needle256);
+
+        if(_mm256_movemask_epi8(_mm256_and_si256(a, b)) == -1) {
+            continue;
+        }
+
+        const uint32_t a_ne = ~static_cast<uint32_t>(_mm256_movemask_epi8(a));
+
+        if(a_ne != 0) {
+            return i + __builtin_ctz(a_ne) / 2;
+        }
+
+        return i + 16 + __builtin_ctz(~static_cast<uint32_t>(_mm256_movemask_epi8(b))) / 2;
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i needle128 = _mm_set1_epi16(value);
+
+    for(; i + 8 <= n; i += 8) {
+        const __m128i eq = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), needle128);
+
+        const uint32_t ne = ~static_cast<uint32_t>(_mm_movemask_epi8(eq)) & 0xFFFF;
+
+        if(ne != 0) {
+            return i + __builtin_ctz(ne) / 2;
+        }
+    }
+#endif
+
+    for(; i < n; i++) {
+        if(values[i] != value) {
+            return i;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief length of the run of values equal to values[0], at most n
+ * compares 16 values (AVX2) or 4 values (SSE2) at a time, the tail is scalar
+ **/
+static inline uintmax_t runLength(
+    const uint32_t* const values,
+    const uintmax_t n
+) {
+    const uint32_t value = values[0];
+
+    uintmax_t i = 1;
+
+#if defined(__AVX2__)
+    const __m256i needle256 = _mm256_set1_epi32(value);
+
+    for(; i + 16 <= n; i += 16) {
+        const __m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), needle256);
+        const __m256i b = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 8)), needle256);
+
+        if(_mm256_movemask_epi8(_mm256_and_si256(a, b)) == -1) {
+            continue;
+        }
+
+        const uint32_t a_ne = ~static_cast<uint32_t>(_mm256_movemask_epi8(a));
+
+        if(a_ne != 0) {
+            return i + __builtin_ctz(a_ne) / 4;
+        }
+
+        return i + 8 + __builtin_ctz(~static_cast<uint32_t>(_mm256_movemask_epi8(b))) / 4;
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i needle128 = _mm_set1_epi32(value);
+
+    for(; i + 4 <= n; i += 4) {
+        const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), needle128);
+
+        const uint32_t ne = ~static_cast<uint32_t>(_mm_movemask_epi8(eq)) & 0xFFFF;
+
+        if(ne != 0) {
+            return i + __builtin_ctz(ne) / 4;
+        }
+    }
+#endif
+
+    for(; i < n; i++) {
+        if(values[i] != value) {
+            return i;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief first i with values[i] == values[i + 1], n if no two neighbours are equal
+ * text without repeats is skipped 8 (AVX2) or 4 (SSE2) values at a time
+ **/
+static inline uintmax_t findRepeat(
+    const uint32_t* const values,
+    const uintmax_t n
+) {
+    uintmax_t i = 0;
+
+#if defined(__AVX2__)
+    for(; i + 9 <= n; i += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 1));
+
+        const uint32_t eq = _mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b));
+
+        if(eq != 0) {
+            return i + __builtin_ctz(eq) / 4;
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    for(; i + 5 <= n; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 1));
+
+        const uint32_t eq = _mm_movemask_epi8(_mm_cmpeq_epi32(a, b));
+
+        if(eq != 0) {
+            return i + __builtin_ctz(eq) / 4;
+        }
+    }
+#endif
+
+    for(; i + 1 < n; i++) {
+        if(values[i] == values[i + 1]) {
+            return i;
+        }
+    }
+
+    return n;
+}
+
+}
@@ -142,13 +142,19 @@ struct Box {
         const Text& other
     ) const;
 
-    inline size_t size() {
+    inline size_t size() const {
         return _width * _height;
     }
 
     inline bool takesUpSpace() const {
         return _width > 0 && _height > 0;
     }
+
+    inline bool operator==(
+        const Box& other
+    ) const {
+        return _width == other._width && _height == other._height;
+    }
 };
 
 struct FloatingBox {
@@ -199,7 +205,7 @@ struct FloatingBox {
         const Box& term
     ) const;
 
-    inline size_t size() {
+    inline size_t size() const {
         return _box.size();
     }
 
@@ -358,6 +364,85 @@ static inline bool overlap(
            b.topLeft().isInside(a) || b.bottomLeft().isInside(a) || b.topRight().isInside(a) || b.bottomRight().isInside(a);
 }
 
+/**
+ * @brief the cells both a and b cover, a box that takes up no space if there are none
+ **/
+static inline FloatingBox intersect(
+    const FloatingBox& a,
+    const FloatingBox& b
+) {
+    const size_t left = a._pos._x > b._pos._x ? a._pos._x : b._pos._x;
+    const size_t top = a._pos._y > b._pos._y ? a._pos._y : b._pos._y;
+
+    const size_t a_end_x = a._pos._x + a._box._width;
+    const size_t b_end_x = b._pos._x + b._box._width;
+    const size_t a_end_y = a._pos._y + a._box._height;
+    const size_t b_end_y = b._pos._y + b._box._height;
+
+    const size_t end_x = a_end_x < b_end_x ? a_end_x : b_end_x;
+    const size_t end_y = a_end_y < b_end_y ? a_end_y : b_end_y;
+
+    if(end_x <= left || end_y <= top) {
+        return {._pos = {._x = left, ._y = top}, ._box = {._width = 0, ._height = 0}};
+    }
+
+    return {._pos = {._x = left, ._y = top}, ._box = {._width = end_x - left, ._height = end_y - top}};
+}
+
+/**
+ * @brief the cells of a that b does not cover as up to 4 boxes that do not overlap, returns how many were written to out
+ * the rows above and below b span all of a, the ones beside b only b's rows
+ **/
+static inline uintmax_t subtract(
+    const FloatingBox& a,
+    const FloatingBox& b,
+    FloatingBox out[4]
+) {
+    if(!a.takesUpSpace()) {
+        return 0;
+    }
+
+    const FloatingBox cut = intersect(a, b);
+
+    if(!cut.takesUpSpace()) {
+        out[0] = a;
+        return 1;
+    }
+
+    const size_t a_end_x = a._pos._x + a._box._width;
+    const size_t a_end_y = a._pos._y + a._box._height;
+    const size_t cut_end_x = cut._pos._x + cut._box._width;
+    const size_t cut_end_y = cut._pos._y + cut._box._height;
+
+    uintmax_t n = 0;
+
+    if(cut._pos._y > a._pos._y) {
+        out[n++] = {._pos = a._pos, ._box = {._width = a._box._width, ._height = cut._pos._y - a._pos._y}};
+    }
+
+    if(cut_end_y < a_end_y) {
+        out[n++] = {._pos = {._x = a._pos._x, ._y = cut_end_y}, ._box = {._width = a._box._width, ._height = a_end_y - cut_end_y}};
+    }
+
+    if(cut._pos._x > a._pos._x) {
+        out[n++] = {._pos = {._x = a._pos._x, ._y = cut._pos._y}, ._box = {._width = cut._pos._x - a._pos._x, ._height = cut._box._height}};
+    }
+
+    if(cut_end_x < a_end_x) {
+        out[n++] = {._pos = {._x = cut_end_x, ._y = cut._pos._y}, ._box = {._width = a_end_x - cut_end_x, ._height = cut._box._height}};
+    }
+
+    return n;
+}
+
+// boxes that cross without either having a corner inside the other overlap too
+static inline bool overlap(
+    const FloatingBox& a,
+    const FloatingBox& b
+) {
+    return intersect(a, b).takesUpSpace();
+}
+
 
 static inline bool overlap(
     const Text& a,
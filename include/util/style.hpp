@@ -34,6 +34,9 @@ static inline void setEnconding(
     setBitRangeTo(style, static_cast<uint8_t>(encoding), Range::fromFor(62, 2));
 }
 
+// a style that is not known, e.g. what a terminal shows before anything set it. no encoding uses both top bits
+constexpr uint64_t STYLE_UNKNOWN = UINT64_MAX;
+
 enum class ColorMode {
     Default = 0,   // Restores Back to the default color using ^[[0m
     FullColor = 1, // 24bit colors
@@ -91,7 +94,7 @@ static inline void setFCA(
     uint32_t& color,
     const uint8_t value
 ) {
-    setBitRangeTo(color, value, Range::fromFor(14, 4));
+    setBitRangeTo(color, value, Range::fromFor(24, 4));
 }
 
 static inline ColorMode getFgMode(
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <time.h>
 #include <errno.h>
+#include <sys/ioctl.h>
 
 namespace Tesix {
 
@@ -18,6 +20,32 @@ static void enableRawMode() {
     tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
 }
 
+/**
+ * @brief makes writes to fd return EAGAIN instead of blocking, the flag is shared by every process writing to the terminal
+ **/
+static void enableNonblocking(
+    const uintmax_t fd
+) {
+    const int flags = fcntl(fd, F_GETFL);
+
+    if(flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+/**
+ * @brief undoes enableNonblocking(), async signal safe
+ **/
+static void disableNonblocking(
+    const uintmax_t fd
+) {
+    const int flags = fcntl(fd, F_GETFL);
+
+    if(flags >= 0) {
+        fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    }
+}
+
 static intmax_t msleep(
     const uintmax_t ms
 ) {
@@ -39,4 +67,27 @@ static intmax_t msleep(
     return ret;
 }
 
+static inline uint64_t monotonicNs() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief bytes written to the terminal fd that the terminal has not read yet, 0 if fd is not a tty
+ **/
+static inline uintmax_t pendingOutputBytes(
+    const uintmax_t fd
+) {
+    int n = 0;
+
+    if(ioctl(fd, TIOCOUTQ, &n) < 0 || n < 0) {
+        return 0;
+    }
+
+    return n;
+}
+
 }
@@ -4,12 +4,20 @@
 #include "array.hpp"
 
 #include <stdint.h>
-#include <stdexcept>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace Tesix {
 
 namespace UTF {
 
+// stands in for malformed UTF-8
+constexpr uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
 
 }
 
@@ -84,32 +92,442 @@ static void toUTF8(
     }
 }
 
+static inline uint8_t* toUTF8Scalar(
+    uint8_t* dest,
+    const uint32_t codepoint
+) {
+    if(codepoint < 0x80) {
+        dest[0] = codepoint;
+        return dest + 1;
+    }
+
+    if(codepoint < 0x800) {
+        dest[0] = 0b11000000 | (codepoint >> 6);
+        dest[1] = 0b10000000 | (codepoint & 0b111111);
+        return dest + 2;
+    }
+
+    if(codepoint < 0x10000) {
+        dest[0] = 0b11100000 | (codepoint >> 12);
+        dest[1] = 0b10000000 | ((codepoint >> 6) & 0b111111);
+        dest[2] = 0b10000000 | (codepoint & 0b111111);
+        return dest + 3;
+    }
+
+    dest[0] = 0b11110000 | ((codepoint >> 18) & 0b111);
+    dest[1] = 0b10000000 | ((codepoint >> 12) & 0b111111);
+    dest[2] = 0b10000000 | ((codepoint >> 6) & 0b111111);
+    dest[3] = 0b10000000 | (codepoint & 0b111111);
+    return dest + 4;
+}
+
+#if defined(__AVX2__)
+
+constexpr uintmax_t ASCII_BLOCK_C = 32;
+
+/**
+ * @brief narrows ASCII_BLOCK_C codepoints to bytes, returns false without writing if any of them is not ASCII
+ **/
+static inline bool toUTF8ASCIIBlock(
+    uint8_t* const dest,
+    const uint32_t* const utf32
+) {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf32));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf32 + 8));
+    const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf32 + 16));
+    const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf32 + 24));
+
+    const __m256i all = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+
+    if(!_mm256_testz_si256(all, _mm256_set1_epi32(~0x7F))) {
+        return false;
+    }
+
+    const __m256i ab = _mm256_packs_epi32(a, b);
+    const __m256i cd = _mm256_packs_epi32(c, d);
+    const __m256i bytes = _mm256_packus_epi16(ab, cd);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+
+    return true;
+}
+
+#elif defined(__SSE2__)
+
+constexpr uintmax_t ASCII_BLOCK_C = 16;
+
+/**
+ * @brief narrows ASCII_BLOCK_C codepoints to bytes, returns false without writing if any of them is not ASCII
+ **/
+static inline bool toUTF8ASCIIBlock(
+    uint8_t* const dest,
+    const uint32_t* const utf32
+) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf32));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf32 + 4));
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf32 + 8));
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf32 + 12));
+
+    const __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+    const __m128i non_ascii = _mm_and_si128(all, _mm_set1_epi32(~0x7F));
+
+    if(_mm_movemask_epi8(_mm_cmpeq_epi32(non_ascii, _mm_setzero_si128())) != 0xFFFF) {
+        return false;
+    }
+
+    const __m128i ab = _mm_packs_epi32(a, b);
+    const __m128i cd = _mm_packs_epi32(c, d);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_packus_epi16(ab, cd));
+
+    return true;
+}
+
+#else
+
+constexpr uintmax_t ASCII_BLOCK_C = 8;
+
+static inline bool toUTF8ASCIIBlock(
+    uint8_t* const dest,
+    const uint32_t* const utf32
+) {
+    uint32_t all = 0;
+
+    for(uintmax_t i = 0; i < ASCII_BLOCK_C; i++) {
+        all |= utf32[i];
+    }
+
+    if(all >= 0x80) {
+        return false;
+    }
+
+    for(uintmax_t i = 0; i < ASCII_BLOCK_C; i++) {
+        dest[i] = utf32[i];
+    }
+
+    return true;
+}
+
+#endif
+
+/**
+ * @brief encodes a whole run of codepoints, dest has to have space for the encoded run (at most 4 * utf32_c bytes)
+ * @return the amount of bytes written
+ **/
+static uintmax_t toUTF8Bulk(
+    uint8_t* const dest,
+    const uint32_t* const utf32,
+    const uintmax_t utf32_c
+) {
+    uint8_t* dest_cur = dest;
+    uintmax_t i = 0;
+
+    while(i + ASCII_BLOCK_C <= utf32_c) {
+        if(toUTF8ASCIIBlock(dest_cur, utf32 + i)) {
+            dest_cur += ASCII_BLOCK_C;
+            i += ASCII_BLOCK_C;
+            continue;
+        }
+
+        for(const uintmax_t block_end = i + ASCII_BLOCK_C; i < block_end; i++) {
+            dest_cur = toUTF8Scalar(dest_cur, utf32[i]);
+        }
+    }
+
+    for(; i < utf32_c; i++) {
+        dest_cur = toUTF8Scalar(dest_cur, utf32[i]);
+    }
+
+    return dest_cur - dest;
+}
+
 }
 
 namespace UTF8 {
 
-static uintmax_t octetCount(
-    const uint8_t* const codepoint
+/**
+ * @brief decodes the sequence at utf8 into codepoint and how many of the remaining bytes it took into octet_c, false if it is malformed
+ * a malformed sequence becomes UTF::REPLACEMENT_CHARACTER and takes the longest prefix of it that could have been valid, at least one byte
+ * overlong encodings, surrogates and codepoints past U+10FFFF are malformed
+ **/
+static inline bool decodeSingle(
+    const uint8_t* const utf8,
+    const uintmax_t remaining,
+    uint32_t& codepoint,
+    uintmax_t& octet_c
+) {
+    const uint8_t lead = utf8[0];
+
+    if(lead < 0x80) {
+        codepoint = lead;
+        octet_c = 1;
+        return true;
+    }
+
+    if(lead < 0xC2 || lead > 0xF4) {
+        codepoint = UTF::REPLACEMENT_CHARACTER;
+        octet_c = 1;
+        return false;
+    }
+
+    const uintmax_t len = lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+
+    // the second byte's range rules out overlong encodings, surrogates and codepoints that are too large
+    uint8_t low = lead == 0xE0 ? 0xA0 : lead == 0xF0 ? 0x90 : 0x80;
+    uint8_t high = lead == 0xED ? 0x9F : lead == 0xF4 ? 0x8F : 0xBF;
+
+    uint32_t value = lead & (0x7F >> len);
+
+    for(uintmax_t i = 1; i < len; i++) {
+        if(i >= remaining || utf8[i] < low || utf8[i] > high) {
+            codepoint = UTF::REPLACEMENT_CHARACTER;
+            octet_c = i;
+            return false;
+        }
+
+        value = (value << 6) | (utf8[i] & 0b111111);
+
+        low = 0x80;
+        high = 0xBF;
+    }
+
+    codepoint = value;
+    octet_c = len;
+    return true;
+}
+
+/**
+ * @brief decodes the sequence at utf8 without checking it, only for input isValid() accepted
+ * @return the length of the sequence
+ **/
+static inline uintmax_t decodeValidSingle(
+    const uint8_t* const utf8,
+    uint32_t& codepoint
 ) {
-    if(rShiftExactOverflow(codepoint[0], 7) == 0b0) {
+    const uint8_t lead = utf8[0];
+
+    if(lead < 0x80) {
+        codepoint = lead;
         return 1;
     }
 
-    if(rShiftExactOverflow(codepoint[0], 5) == 0b110) {
+    if(lead < 0xE0) {
+        codepoint = (lead & 0x1F) << 6 | (utf8[1] & 0x3F);
         return 2;
     }
 
-    if(rShiftExactOverflow(codepoint[0], 4) == 0b1110) {
+    if(lead < 0xF0) {
+        codepoint = (lead & 0x0F) << 12 | (utf8[1] & 0x3F) << 6 | (utf8[2] & 0x3F);
         return 3;
     }
 
-    if(rShiftExactOverflow(codepoint[0], 3) == 0b11110) {
-        return 4;
+    codepoint = (lead & 0x07) << 18 | (utf8[1] & 0x3F) << 12 | (utf8[2] & 0x3F) << 6 | (utf8[3] & 0x3F);
+    return 4;
+}
+
+#if defined(__AVX2__)
+
+// decodeInto() validates non-ASCII text VALIDATE_CHUNK_C bytes at a time and decodes valid chunks with decodeValidSingle()
+constexpr bool BULK_VALIDATION = true;
+
+// error bits of the lookup tables, a pair of bytes is malformed if every table sets the same bit for it
+constexpr uint8_t UTF8_TOO_SHORT = 1 << 0;
+constexpr uint8_t UTF8_TOO_LONG = 1 << 1;
+constexpr uint8_t UTF8_OVERLONG_3 = 1 << 2;
+constexpr uint8_t UTF8_TOO_LARGE = 1 << 3;
+constexpr uint8_t UTF8_SURROGATE = 1 << 4;
+constexpr uint8_t UTF8_OVERLONG_2 = 1 << 5;
+constexpr uint8_t UTF8_TOO_LARGE_1000 = 1 << 6;
+constexpr uint8_t UTF8_OVERLONG_4 = 1 << 6;
+constexpr uint8_t UTF8_TWO_CONTS = 1 << 7;
+constexpr uint8_t UTF8_CARRY = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS;
+
+static inline __m256i lookupNibbles(
+    const __m256i nibbles,
+    const uint8_t* const table
+) {
+    const __m256i lanes = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+
+    return _mm256_shuffle_epi8(lanes, nibbles);
+}
+
+/**
+ * @brief the bytes of block shifted right by n (1 to 3) bytes, the last bytes of prev fill in at the start
+ **/
+template<int n>
+static inline __m256i previousBytes(
+    const __m256i block,
+    const __m256i prev
+) {
+    return _mm256_alignr_epi8(block, _mm256_permute2x128_si256(prev, block, 0x21), 16 - n);
+}
+
+/**
+ * @brief nonzero where block, which follows prev, is not UTF-8. classifies every byte together with the one before it by three 16 entry tables
+ **/
+static inline __m256i findUTF8Errors(
+    const __m256i block,
+    const __m256i prev
+) {
+    static const uint8_t byte_1_high[16] = {
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    };
+
+    static const uint8_t byte_1_low[16] = {
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    };
+
+    static const uint8_t byte_2_high[16] = {
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    };
+
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+
+    const __m256i prev1 = previousBytes<1>(block, prev);
+
+    const __m256i special = _mm256_and_si256(
+        _mm256_and_si256(
+            lookupNibbles(_mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble), byte_1_high),
+            lookupNibbles(_mm256_and_si256(prev1, low_nibble), byte_1_low)
+        ),
+        lookupNibbles(_mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibble), byte_2_high)
+    );
+
+    // the second continuation of a 3 or 4 byte sequence and the third of a 4 byte one, the tables above only see pairs
+    const __m256i third = _mm256_subs_epu8(previousBytes<2>(block, prev), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m256i fourth = _mm256_subs_epu8(previousBytes<3>(block, prev), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+
+    const __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+    return _mm256_xor_si256(must_continue, special);
+}
+
+/**
+ * @brief nonzero where a sequence that starts in the last 3 bytes of block would need bytes past it
+ **/
+static inline __m256i findIncomplete(
+    const __m256i block
+) {
+    const __m256i max = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1)
+    );
+
+    return _mm256_subs_epu8(block, max);
+}
+
+/**
+ * @brief true if utf8 is well formed, 32 bytes at a time
+ **/
+static bool isValid(
+    const uint8_t* const utf8,
+    const uintmax_t utf8_c
+) {
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+
+    uintmax_t i = 0;
+
+    for(; i + 32 <= utf8_c; i += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf8 + i));
+
+        if(_mm256_movemask_epi8(block) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+        } else {
+            error = _mm256_or_si256(error, findUTF8Errors(block, prev));
+            prev_incomplete = findIncomplete(block);
+        }
+
+        prev = block;
+    }
+
+    if(i < utf8_c) {
+        // zero padding is ASCII, a sequence the input cuts off shows up as too short
+        uint8_t tail[32] = {};
+
+        memcpy(tail, utf8 + i, utf8_c - i);
+
+        error = _mm256_or_si256(error, findUTF8Errors(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail)), prev));
+    } else {
+        error = _mm256_or_si256(error, prev_incomplete);
     }
 
-    throw std::runtime_error("invalid UTF8");
+    return _mm256_testz_si256(error, error);
 }
 
+#else
+
+// the scalar isValid() checks every sequence with decodeSingle(), running it ahead of decoding would only double the work
+constexpr bool BULK_VALIDATION = false;
+
+/**
+ * @brief true if utf8 is well formed, ASCII is skipped a block at a time
+ **/
+static bool isValid(
+    const uint8_t* const utf8,
+    const uintmax_t utf8_c
+) {
+    uintmax_t i = 0;
+
+    while(i < utf8_c) {
+        if(i + 8 <= utf8_c) {
+            uint64_t block;
+
+            memcpy(&block, utf8 + i, 8);
+
+            if((block & 0x8080808080808080) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+
+        uint32_t codepoint;
+        uintmax_t octet_c;
+
+        if(!decodeSingle(utf8 + i, utf8_c - i, codepoint, octet_c)) {
+            return false;
+        }
+
+        i += octet_c;
+    }
+
+    return true;
+}
+
+#endif
+
+/**
+ * @brief the amount of codepoints utf8 decodes to, malformed sequences included
+ **/
 static uintmax_t countUTF32(
     const uint8_t* const utf8,
     const uintmax_t utf8_c
@@ -117,8 +535,11 @@ static uintmax_t countUTF32(
     uintmax_t utf32_c = 0;
     uintmax_t utf8_cur = 0;
 
-    while (utf8_cur < utf8_c) {
-        const uintmax_t octet_c = octetCount(utf8 + utf8_cur);
+    while(utf8_cur < utf8_c) {
+        uint32_t codepoint;
+        uintmax_t octet_c;
+
+        decodeSingle(utf8 + utf8_cur, utf8_c - utf8_cur, codepoint, octet_c);
 
         utf8_cur += octet_c;
         utf32_c++;
@@ -127,73 +548,198 @@ static uintmax_t countUTF32(
     return utf32_c;
 }
 
-static void toUTF32Single(
+/**
+ * @brief where decodeInto() is in its input and how many malformed sequences it replaced so far
+ **/
+struct Decoder {
+    uintmax_t _cur;
+    uintmax_t _invalid_c;
+};
+
+#if defined(__AVX2__)
+
+constexpr uintmax_t ASCII_BLOCK_C = 32;
+
+/**
+ * @brief widens ASCII_BLOCK_C bytes to codepoints, returns false without writing if any of them is not ASCII
+ **/
+static inline bool toUTF32ASCIIBlock(
     uint32_t* const dest,
-    const uint8_t* const utf8,
-    const uintmax_t octet_c
+    const uint8_t* const utf8
 ) {
-    switch(octet_c) {
-        case 1: {
-            dest[0] = getBits(utf8[0], Range::fromFor(0, 7));
-        } break;
-        case 2: {
-            uint32_t codepoint = 0;
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf8));
 
-            codepoint |= valueMask(utf8[0], Range::fromFor(6, 5));
-            codepoint |= getBits(utf8[1], Range::fromFor(0, 6));
+    if(_mm256_movemask_epi8(bytes) != 0) {
+        return false;
+    }
 
-            dest[0] = codepoint;
-        } break;
-        case 3: {
-            uint32_t codepoint = 0;
+    for(uintmax_t i = 0; i < ASCII_BLOCK_C; i += 8) {
+        const __m128i eight = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(utf8 + i));
 
-            codepoint |= valueMask(utf8[0], Range::fromFor(12, 4));
-            codepoint |= valueMask(utf8[1], Range::fromFor(6, 6));
-            codepoint |= getBits(utf8[2], Range::fromFor(0, 6));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_cvtepu8_epi32(eight));
+    }
 
-            dest[0] = codepoint;
-        } break;
-        case 4: {
-            uint32_t codepoint = 0;
+    return true;
+}
 
-            codepoint |= valueMask(utf8[0], Range::fromFor(18, 4));
-            codepoint |= valueMask(utf8[1], Range::fromFor(12, 6));
-            codepoint |= valueMask(utf8[2], Range::fromFor(6, 6));
-            codepoint |= getBits(utf8[3], Range::fromFor(0, 6));
+#elif defined(__SSE2__)
 
-            dest[0] = codepoint;
-        } break;
-        default: {
-        } break;
+constexpr uintmax_t ASCII_BLOCK_C = 16;
+
+/**
+ * @brief widens ASCII_BLOCK_C bytes to codepoints, returns false without writing if any of them is not ASCII
+ **/
+static inline bool toUTF32ASCIIBlock(
+    uint32_t* const dest,
+    const uint8_t* const utf8
+) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8));
+
+    if(_mm_movemask_epi8(bytes) != 0) {
+        return false;
     }
 
+    const __m128i zero = _mm_setzero_si128();
+
+    const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+    const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi16(low, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), _mm_unpackhi_epi16(low, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 8), _mm_unpacklo_epi16(high, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 12), _mm_unpackhi_epi16(high, zero));
+
+    return true;
 }
 
-static Array<uint32_t> toUTF32(
+#else
+
+constexpr uintmax_t ASCII_BLOCK_C = 8;
+
+static inline bool toUTF32ASCIIBlock(
+    uint32_t* const dest,
+    const uint8_t* const utf8
+) {
+    uint8_t all = 0;
+
+    for(uintmax_t i = 0; i < ASCII_BLOCK_C; i++) {
+        all |= utf8[i];
+    }
+
+    if(all >= 0x80) {
+        return false;
+    }
+
+    for(uintmax_t i = 0; i < ASCII_BLOCK_C; i++) {
+        dest[i] = utf8[i];
+    }
+
+    return true;
+}
+
+#endif
+
+constexpr uintmax_t VALIDATE_CHUNK_C = 64;
+
+/**
+ * @brief end of the chunk of at most VALIDATE_CHUNK_C bytes from utf8_cur, moved back so it does not cut a sequence in two
+ **/
+static inline uintmax_t validateChunkEnd(
     const uint8_t* const utf8,
+    const uintmax_t utf8_cur,
     const uintmax_t utf8_c
 ) {
-    const uintmax_t utf32_c = countUTF32(utf8, utf8_c);
+    if(utf8_c - utf8_cur <= VALIDATE_CHUNK_C) {
+        return utf8_c;
+    }
 
-    uint32_t* const utf32 = Array<uint32_t>::allocRaw(utf32_c);
+    uintmax_t end = utf8_cur + VALIDATE_CHUNK_C;
 
-    uintmax_t utf8_cur = 0;
-    uintmax_t utf32_cur = 0;
+    // a stray continuation past these is malformed anyway and fails the next chunk
+    for(uintmax_t i = 0; i < 3 && (utf8[end] & 0xC0) == 0x80; i++) {
+        end--;
+    }
 
-    while(utf32_cur < utf32_c) {
-        const uintmax_t octet_c = octetCount(utf8 + utf8_cur);
+    return end;
+}
+
+/**
+ * @brief decodes utf8 from decoder._cur into dest until dest_cap codepoints are written or utf8 ends, nothing is allocated
+ * decoder._cur is left after the last decoded sequence, malformed ones are decoded as UTF::REPLACEMENT_CHARACTER and counted in decoder._invalid_c
+ * @return the amount of codepoints written
+ **/
+static uintmax_t decodeInto(
+    uint32_t* const dest,
+    const uintmax_t dest_cap,
+    const uint8_t* const utf8,
+    const uintmax_t utf8_c,
+    Decoder& decoder
+) {
+    uintmax_t dest_cur = 0;
+    uintmax_t utf8_cur = decoder._cur;
+
+    // the chunk utf8_cur is in and whether isValid() accepted it
+    uintmax_t chunk_end = utf8_cur;
+    bool chunk_valid = false;
+
+    while(dest_cur < dest_cap && utf8_cur < utf8_c) {
+        if(dest_cur + ASCII_BLOCK_C <= dest_cap && utf8_cur + ASCII_BLOCK_C <= utf8_c && toUTF32ASCIIBlock(dest + dest_cur, utf8 + utf8_cur)) {
+            dest_cur += ASCII_BLOCK_C;
+            utf8_cur += ASCII_BLOCK_C;
+            continue;
+        }
+
+        if constexpr(BULK_VALIDATION) {
+            if(utf8_cur >= chunk_end) {
+                chunk_end = validateChunkEnd(utf8, utf8_cur, utf8_c);
+                chunk_valid = isValid(utf8 + utf8_cur, chunk_end - utf8_cur);
+            }
+
+            if(chunk_valid) {
+                while(utf8_cur < chunk_end && dest_cur < dest_cap && utf8[utf8_cur] >= 0x80) {
+                    utf8_cur += decodeValidSingle(utf8 + utf8_cur, dest[dest_cur]);
+                    dest_cur++;
+                }
+
+                // a lone ASCII byte between the sequences, longer ASCII runs are left to the block path
+                if(utf8_cur < chunk_end && dest_cur < dest_cap) {
+                    dest[dest_cur++] = utf8[utf8_cur++];
+                }
+
+                continue;
+            }
+        }
+
+        uintmax_t octet_c;
 
-        toUTF32Single(utf32 + utf32_cur, utf8 + utf8_cur, octet_c);
+        decoder._invalid_c += !decodeSingle(utf8 + utf8_cur, utf8_c - utf8_cur, dest[dest_cur], octet_c);
 
         utf8_cur += octet_c;
-        utf32_cur++;
+        dest_cur++;
     }
 
-    return Array<uint32_t>::fromRawFull(utf32, utf32_c);
+    decoder._cur = utf8_cur;
 
+    return dest_cur;
 }
 
+/**
+ * @brief decodes utf8 into a new array, malformed sequences become UTF::REPLACEMENT_CHARACTER
+ **/
+static Array<uint32_t> toUTF32(
+    const uint8_t* const utf8,
+    const uintmax_t utf8_c
+) {
+    const uintmax_t utf32_c = countUTF32(utf8, utf8_c);
+
+    uint32_t* const utf32 = Array<uint32_t>::allocRaw(utf32_c);
+
+    Decoder decoder = {._cur = 0, ._invalid_c = 0};
 
+    decodeInto(utf32, utf32_c, utf8, utf8_c, decoder);
+
+    return Array<uint32_t>::fromRawFull(utf32, utf32_c);
+}
 
 } // namespace UTF8
 
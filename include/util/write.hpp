@@ -3,8 +3,7 @@
 #include "util/string.hpp"
 
 #include <inttypes.h>
-#include <math.h>
-#include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 
 namespace Tesix {
@@ -35,17 +34,121 @@ static inline uint8_t* const writeByte(
     return buf + 1;
 }
 
+constexpr uint64_t POWERS_OF_TEN[] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+static consteval auto createDigitPairs() {
+    struct {
+        uint8_t _c[200];
+    } pairs = {};
+
+    for(uintmax_t i = 0; i < 100; i++) {
+        pairs._c[i * 2] = '0' + i / 10;
+        pairs._c[i * 2 + 1] = '0' + i % 10;
+    }
+
+    return pairs;
+}
+
+constexpr auto DIGIT_PAIRS = createDigitPairs();
+
+struct UInt8Digits {
+    uint8_t _c[3];
+    uint8_t _n;
+};
+
+static consteval auto createUInt8Digits() {
+    struct {
+        UInt8Digits _v[256];
+    } table = {};
+
+    for(uintmax_t i = 0; i < 256; i++) {
+        if(i >= 100) {
+            table._v[i] = {._c = {static_cast<uint8_t>('0' + i / 100), static_cast<uint8_t>('0' + i / 10 % 10), static_cast<uint8_t>('0' + i % 10)}, ._n = 3};
+        } else if(i >= 10) {
+            table._v[i] = {._c = {static_cast<uint8_t>('0' + i / 10), static_cast<uint8_t>('0' + i % 10), 0}, ._n = 2};
+        } else {
+            table._v[i] = {._c = {static_cast<uint8_t>('0' + i), 0, 0}, ._n = 1};
+        }
+    }
+
+    return table;
+}
+
+constexpr auto UINT8_DIGITS = createUInt8Digits();
+
 static inline uintmax_t countDigits(
     const uintmax_t value
 ) {
-    return value > 0 ? (int) log10((double) value) + 1 : 1;
+    const uint64_t v = value | 1;
+
+    // floor(log10(2) * bit width) is either the exact digit count minus one or one too many
+    const uint64_t approx = ((64 - __builtin_clzll(v)) * 1233) >> 12;
+
+    return approx + 1 - (v < POWERS_OF_TEN[approx]);
+}
+
+static inline uintmax_t countDigits(
+    const uint8_t value
+) {
+    return UINT8_DIGITS._v[value]._n;
 }
 
 static uint8_t* writeUInt(
     uint8_t* const dest,
     const uintmax_t val
 ) {
-    return dest + sprintf(asCStr(dest), "%lu", val);
+    const uintmax_t digit_c = countDigits(val);
+
+    uint8_t* cur = dest + digit_c;
+    uintmax_t rem = val;
+
+    while(rem >= 100) {
+        cur -= 2;
+        memcpy(cur, DIGIT_PAIRS._c + (rem % 100) * 2, 2);
+        rem /= 100;
+    }
+
+    if(rem >= 10) {
+        cur -= 2;
+        memcpy(cur, DIGIT_PAIRS._c + rem * 2, 2);
+    } else {
+        cur -= 1;
+        cur[0] = '0' + rem;
+    }
+
+    return dest + digit_c;
+}
+
+static inline uint8_t* writeUInt(
+    uint8_t* const dest,
+    const uint8_t val
+) {
+    const UInt8Digits& digits = UINT8_DIGITS._v[val];
+
+    memcpy(dest, digits._c, digits._n);
+
+    return dest + digits._n;
 }
 
 }
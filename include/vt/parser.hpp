@@ -0,0 +1,535 @@
+#pragma once
+
+#include "vt/terminal.hpp"
+
+#include "util/style.hpp"
+
+#include <stdint.h>
+
+namespace Tesix {
+
+namespace Vt {
+
+/**
+ * @brief parameter i of the current sequence, def if it is missing or 0
+ **/
+static inline uint32_t param(
+    const Terminal& term,
+    const uintmax_t i,
+    const uint32_t def
+) {
+    return i < term._param_c && term._params[i] != 0 ? term._params[i] : def;
+}
+
+/**
+ * @brief reads 38 / 48 color parameters starting at i, returns the index of the last parameter it used
+ * only 24 bit colors and the 16 palette colors Tesix can encode are supported
+ **/
+static uintmax_t applySGRColor(
+    Terminal& term,
+    Style::Style& style,
+    uintmax_t i,
+    const bool fg
+) {
+    const uint32_t kind = i + 1 < term._param_c ? term._params[i + 1] : 0;
+
+    if(kind == 2 && i + 4 < term._param_c) {
+        const Color32 color = {
+            ._r = static_cast<uint8_t>(term._params[i + 2]),
+            ._g = static_cast<uint8_t>(term._params[i + 3]),
+            ._b = static_cast<uint8_t>(term._params[i + 4]),
+            ._a = 0
+        };
+
+        if(fg) {
+            style.fgFullColor(color);
+        } else {
+            style.bgFullColor(color);
+        }
+
+        return i + 4;
+    }
+
+    if(kind == 5 && i + 2 < term._param_c && term._params[i + 2] < 16) {
+        const uint8_t color = term._params[i + 2];
+
+        if(fg) {
+            style.fgPalette(color);
+        } else {
+            style.bgPalette(color);
+        }
+
+        return i + 2;
+    }
+
+    term._stats._unsupported_c++;
+
+    return term._param_c;
+}
+
+static void applySGR(
+    Terminal& term
+) {
+    Style::Style style = Style::Style::fromEncoding(term._style);
+
+    for(uintmax_t i = 0; i < term._param_c; i++) {
+        const uint32_t p = term._params[i];
+
+        if(p == 0) {
+            style = Style::Style::fromEncoding(0);
+        } else if(p == 1 || p == 22) {
+            style.bold(p == 1);
+        } else if(p == 3 || p == 23) {
+            style.italic(p == 3);
+        } else if(p == 4 || p == 24) {
+            style.underlined(p == 4);
+        } else if(p == 5 || p == 25) {
+            style.blinking(p == 5);
+        } else if(p == 7 || p == 27) {
+            style.reverse(p == 7);
+        } else if(p == 9 || p == 29) {
+            style.strikethrough(p == 9);
+        } else if(p >= 30 && p <= 37) {
+            style.fgPalette(p - 30);
+        } else if(p >= 90 && p <= 97) {
+            style.fgPalette(p - 90 + 8);
+        } else if(p == 39) {
+            style.fgDefault();
+        } else if(p >= 40 && p <= 47) {
+            style.bgPalette(p - 40);
+        } else if(p >= 100 && p <= 107) {
+            style.bgPalette(p - 100 + 8);
+        } else if(p == 49) {
+            style.bgDefault();
+        } else if(p == 38 || p == 48) {
+            i = applySGRColor(term, style, i, p == 38);
+        } else {
+            term._stats._unsupported_c++;
+        }
+    }
+
+    term._style = style.toEncoding();
+}
+
+static void setPrivateModes(
+    Terminal& term,
+    const bool enable
+) {
+    for(uintmax_t i = 0; i < term._param_c; i++) {
+        switch(term._params[i]) {
+            case 7: {
+                term._autowrap = enable;
+            } break;
+            case 25: {
+                // cursor visibility does not change any cell
+            } break;
+            case 2026: {
+                if(term._synchronized && !enable) {
+                    term._stats._frame_c++;
+                }
+
+                term._synchronized = enable;
+            } break;
+            default: {
+                term._stats._unsupported_c++;
+            } break;
+        }
+    }
+}
+
+static void dispatchCSI(
+    Terminal& term,
+    const uint8_t final
+) {
+    term._stats._sequence_c++;
+
+    if(term._marker == '?' && term._intermediate == 0 && (final == 'h' || final == 'l')) {
+        setPrivateModes(term, final == 'h');
+        return;
+    }
+
+    if(term._marker != 0 || term._intermediate != 0) {
+        term._stats._unsupported_c++;
+        return;
+    }
+
+    const Position cur = term._cursor;
+
+    // relative moves stop at the scroll region's margins when they start inside it
+    const uintmax_t up_limit = cur._y >= term._top ? term._top : 0;
+    const uintmax_t down_limit = cur._y <= term._bottom ? term._bottom : term.height() - 1;
+
+    switch(final) {
+        case 'A':
+        case 'F': {
+            const uintmax_t n = param(term, 0, 1);
+
+            moveCursor(term, final == 'F' ? 0 : cur._x, cur._y - up_limit > n ? cur._y - n : up_limit);
+        } break;
+        case 'B':
+        case 'E': {
+            const uintmax_t n = param(term, 0, 1);
+
+            moveCursor(term, final == 'E' ? 0 : cur._x, down_limit - cur._y > n ? cur._y + n : down_limit);
+        } break;
+        case 'C': {
+            moveCursor(term, cur._x + param(term, 0, 1), cur._y);
+        } break;
+        case 'D': {
+            const uintmax_t n = param(term, 0, 1);
+
+            moveCursor(term, cur._x > n ? cur._x - n : 0, cur._y);
+        } break;
+        case 'G':
+        case '`': {
+            moveCursor(term, param(term, 0, 1) - 1, cur._y);
+        } break;
+        case 'd': {
+            moveCursor(term, cur._x, param(term, 0, 1) - 1);
+        } break;
+        case 'H':
+        case 'f': {
+            moveCursor(term, param(term, 1, 1) - 1, param(term, 0, 1) - 1);
+        } break;
+        case 'J': {
+            const uint32_t mode = term._param_c > 0 ? term._params[0] : 0;
+
+            if(mode == 0) {
+                eraseCells(term, cur._y, cur._x, term.width());
+
+                for(uintmax_t y = cur._y + 1; y < term.height(); y++) {
+                    eraseCells(term, y, 0, term.width());
+                }
+            } else if(mode == 1) {
+                for(uintmax_t y = 0; y < cur._y; y++) {
+                    eraseCells(term, y, 0, term.width());
+                }
+
+                eraseCells(term, cur._y, 0, cur._x + 1);
+            } else {
+                for(uintmax_t y = 0; y < term.height(); y++) {
+                    eraseCells(term, y, 0, term.width());
+                }
+            }
+
+            term._wrap_pending = false;
+        } break;
+        case 'K': {
+            const uint32_t mode = term._param_c > 0 ? term._params[0] : 0;
+
+            if(mode == 0) {
+                eraseCells(term, cur._y, cur._x, term.width());
+            } else if(mode == 1) {
+                eraseCells(term, cur._y, 0, cur._x + 1);
+            } else {
+                eraseCells(term, cur._y, 0, term.width());
+            }
+
+            term._wrap_pending = false;
+        } break;
+        case 'X': {
+            eraseCells(term, cur._y, cur._x, cur._x + param(term, 0, 1));
+
+            term._wrap_pending = false;
+        } break;
+        case '@':
+        case 'P': {
+            shiftCharacters(term, param(term, 0, 1), final == '@');
+        } break;
+        case 'L':
+        case 'M': {
+            shiftLines(term, param(term, 0, 1), final == 'L');
+        } break;
+        case 'S':
+        case 'T': {
+            scrollRows(term, term._top, term._bottom, param(term, 0, 1), final == 'S');
+        } break;
+        case 'b': {
+            if(term._last_ch == NO_CHARACTER) {
+                break;
+            }
+
+            for(uintmax_t i = param(term, 0, 1); i > 0; i--) {
+                putCharacter(term, term._last_ch);
+            }
+        } break;
+        case 'r': {
+            const uintmax_t top = param(term, 0, 1) - 1;
+            const uintmax_t bottom = param(term, 1, term.height()) - 1;
+
+            if(top < bottom && bottom < term.height()) {
+                term._top = top;
+                term._bottom = bottom;
+
+                moveCursor(term, 0, 0);
+            }
+        } break;
+        case 's': {
+            term._saved_cursor = cur;
+        } break;
+        case 'u': {
+            moveCursor(term, term._saved_cursor._x, term._saved_cursor._y);
+        } break;
+        case 'm': {
+            applySGR(term);
+        } break;
+        default: {
+            term._stats._unsupported_c++;
+        } break;
+    }
+}
+
+static void dispatchEscape(
+    Terminal& term,
+    const uint8_t final
+) {
+    term._stats._sequence_c++;
+
+    // character set designations, the model only knows one
+    if(term._intermediate == '(' || term._intermediate == ')') {
+        return;
+    }
+
+    if(term._intermediate != 0) {
+        term._stats._unsupported_c++;
+        return;
+    }
+
+    switch(final) {
+        case '7': {
+            term._saved_cursor = term._cursor;
+        } break;
+        case '8': {
+            moveCursor(term, term._saved_cursor._x, term._saved_cursor._y);
+        } break;
+        case 'D': {
+            lineFeed(term);
+        } break;
+        case 'E': {
+            term._cursor._x = 0;
+            lineFeed(term);
+        } break;
+        case 'M': {
+            reverseIndex(term);
+        } break;
+        case 'c': {
+            reset(term);
+        } break;
+        case '=':
+        case '>':
+        case '\\': {
+            // keypad modes and a stray string terminator do not change any cell
+        } break;
+        default: {
+            term._stats._unsupported_c++;
+        } break;
+    }
+}
+
+static void executeControl(
+    Terminal& term,
+    const uint8_t byte
+) {
+    switch(byte) {
+        case '\b': {
+            if(term._cursor._x > 0 && !term._wrap_pending) {
+                term._cursor._x--;
+            }
+
+            term._wrap_pending = false;
+        } break;
+        case '\t': {
+            moveCursor(term, (term._cursor._x / TAB_WIDTH + 1) * TAB_WIDTH, term._cursor._y);
+        } break;
+        case '\n':
+        case '\v':
+        case '\f': {
+            lineFeed(term);
+        } break;
+        case '\r': {
+            term._cursor._x = 0;
+            term._wrap_pending = false;
+        } break;
+        default: {
+            // BEL, NUL and the rest do not change any cell
+        } break;
+    }
+}
+
+/**
+ * @brief decodes one byte of text, codepoints are put on the screen as they complete
+ **/
+static void feedText(
+    Terminal& term,
+    const uint8_t byte
+) {
+    if(term._utf8_remaining > 0) {
+        if((byte & 0xC0) == 0x80) {
+            term._utf8_ch = (term._utf8_ch << 6) | (byte & 0x3F);
+            term._utf8_remaining--;
+
+            if(term._utf8_remaining > 0) {
+                return;
+            }
+
+            const uint32_t ch = term._utf8_ch;
+
+            // overlong encodings, surrogates and codepoints past U+10FFFF
+            const bool valid = term._utf8_len == 2 ? ch >= 0x80
+                : term._utf8_len == 3 ? ch >= 0x800 && (ch < 0xD800 || ch > 0xDFFF)
+                : ch >= 0x10000 && ch <= 0x10FFFF;
+
+            if(!valid) {
+                term._stats._invalid_c++;
+            }
+
+            putCharacter(term, valid ? ch : REPLACEMENT_CHARACTER);
+            return;
+        }
+
+        // the sequence was cut short, byte starts something new
+        term._utf8_remaining = 0;
+        term._stats._invalid_c++;
+
+        putCharacter(term, REPLACEMENT_CHARACTER);
+    }
+
+    if(byte < 0x80) {
+        putCharacter(term, byte);
+        return;
+    }
+
+    if(byte >= 0xC2 && byte <= 0xDF) {
+        term._utf8_ch = byte & 0x1F;
+        term._utf8_len = 2;
+    } else if(byte >= 0xE0 && byte <= 0xEF) {
+        term._utf8_ch = byte & 0x0F;
+        term._utf8_len = 3;
+    } else if(byte >= 0xF0 && byte <= 0xF4) {
+        term._utf8_ch = byte & 0x07;
+        term._utf8_len = 4;
+    } else {
+        // continuation bytes without a lead, C0 / C1 leads of overlong forms and bytes that never occur
+        term._stats._invalid_c++;
+
+        putCharacter(term, REPLACEMENT_CHARACTER);
+        return;
+    }
+
+    term._utf8_remaining = term._utf8_len - 1;
+}
+
+static inline void beginSequence(
+    Terminal& term,
+    const ParserE parser
+) {
+    term._parser = parser;
+
+    term._params[0] = 0;
+    term._param_c = 1;
+    term._marker = 0;
+    term._intermediate = 0;
+}
+
+/**
+ * @brief applies n bytes of terminal output, a sequence or codepoint may continue in the next call
+ **/
+static void feed(
+    Terminal& term,
+    const uint8_t* const bytes,
+    const uintmax_t n
+) {
+    term._stats._byte_c += n;
+
+    for(uintmax_t i = 0; i < n; i++) {
+        const uint8_t byte = bytes[i];
+
+        switch(term._parser) {
+            case ParserE::Ground: {
+                if(byte == 0x1B || byte < 0x20 || byte == 0x7F) {
+                    if(term._utf8_remaining > 0) {
+                        term._utf8_remaining = 0;
+                        term._stats._invalid_c++;
+
+                        putCharacter(term, REPLACEMENT_CHARACTER);
+                    }
+
+                    if(byte == 0x1B) {
+                        beginSequence(term, ParserE::Escape);
+                    } else {
+                        executeControl(term, byte);
+                    }
+                } else {
+                    feedText(term, byte);
+                }
+            } break;
+            case ParserE::Escape: {
+                if(byte == '[') {
+                    beginSequence(term, ParserE::CSI);
+                } else if(byte == ']') {
+                    beginSequence(term, ParserE::OSC);
+                } else if(byte >= 0x20 && byte <= 0x2F) {
+                    term._intermediate = byte;
+                } else if(byte >= 0x30 && byte <= 0x7E) {
+                    term._parser = ParserE::Ground;
+
+                    dispatchEscape(term, byte);
+                } else if(byte == 0x1B) {
+                    beginSequence(term, ParserE::Escape);
+                } else {
+                    executeControl(term, byte);
+                }
+            } break;
+            case ParserE::CSI: {
+                if(byte >= '0' && byte <= '9') {
+                    uint32_t& p = term._params[term._param_c - 1];
+
+                    p = p < UINT16_MAX ? p * 10 + (byte - '0') : p;
+                } else if(byte == ';' || byte == ':') {
+                    if(term._param_c < PARAM_MAX_C) {
+                        term._params[term._param_c++] = 0;
+                    }
+                } else if(byte >= 0x3C && byte <= 0x3F) {
+                    term._marker = byte;
+                } else if(byte >= 0x20 && byte <= 0x2F) {
+                    term._intermediate = byte;
+                } else if(byte >= 0x40 && byte <= 0x7E) {
+                    term._parser = ParserE::Ground;
+
+                    dispatchCSI(term, byte);
+                } else if(byte == 0x1B) {
+                    // an unfinished sequence is dropped
+                    term._stats._unsupported_c++;
+
+                    beginSequence(term, ParserE::Escape);
+                } else {
+                    executeControl(term, byte);
+                }
+            } break;
+            case ParserE::OSC: {
+                if(byte == 0x07) {
+                    term._parser = ParserE::Ground;
+                    term._stats._sequence_c++;
+                } else if(byte == 0x1B) {
+                    term._parser = ParserE::OSCEscape;
+                }
+            } break;
+            case ParserE::OSCEscape: {
+                // ESC \ ends the string, anything else after ESC aborts it and starts a new escape sequence
+                term._stats._sequence_c++;
+
+                if(byte == '\\') {
+                    term._parser = ParserE::Ground;
+                } else {
+                    beginSequence(term, ParserE::Escape);
+
+                    i--;
+                }
+            } break;
+        }
+    }
+}
+
+}
+
+}
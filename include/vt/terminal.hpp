@@ -0,0 +1,356 @@
+#pragma once
+
+#include "util/buffer.hpp"
+#include "util/space.hpp"
+#include "util/style.hpp"
+#include "util/utf.hpp"
+
+#include <stdint.h>
+
+namespace Tesix {
+
+namespace Vt {
+
+// shown for malformed UTF-8
+constexpr uint32_t REPLACEMENT_CHARACTER = UTF::REPLACEMENT_CHARACTER;
+
+// Terminal::_last_ch before anything was printed, REP repeats nothing then
+constexpr uint32_t NO_CHARACTER = UINT32_MAX;
+
+// findMismatch() when every cell matches
+constexpr Position NO_MISMATCH = {._x = UINTMAX_MAX, ._y = UINTMAX_MAX};
+
+constexpr uintmax_t PARAM_MAX_C = 16;
+constexpr uintmax_t TAB_WIDTH = 8;
+
+enum class ParserE {
+    Ground,
+    Escape,
+    CSI,
+    OSC,
+    OSCEscape,
+};
+
+struct Stats {
+    uintmax_t _byte_c;
+
+    // codepoints put on the screen, REP included
+    uintmax_t _printed_c;
+
+    // escape sequences, control sequences and OSC strings, C0 controls are not counted
+    uintmax_t _sequence_c;
+
+    // sequences the model ignored, what they would have done is missing from the screen
+    uintmax_t _unsupported_c;
+
+    // malformed UTF-8 sequences, each shown as U+FFFD
+    uintmax_t _invalid_c;
+
+    // synchronized updates that ended
+    uintmax_t _frame_c;
+};
+
+/**
+ * @brief a headless terminal that applies the ECMA-48 / xterm subset Tesix emits to a grid of cells
+ * every codepoint takes one column, like Tesix's own cell model, erasing uses the current background (bce)
+ **/
+struct Terminal {
+    StyledBuffer _screen;
+
+    Position _cursor;
+    Position _saved_cursor;
+
+    // the last column was written, the next character wraps to the next row first
+    bool _wrap_pending;
+    bool _autowrap;
+
+    uint64_t _style;
+    uint32_t _last_ch;
+
+    // scroll region, both rows included
+    uintmax_t _top;
+    uintmax_t _bottom;
+
+    bool _synchronized;
+
+    // parser state, a sequence may be split across feed() calls
+    ParserE _parser;
+
+    uint32_t _params[PARAM_MAX_C];
+    uintmax_t _param_c;
+
+    // private marker such as '?' and the last intermediate byte, 0 if there is none
+    uint8_t _marker;
+    uint8_t _intermediate;
+
+    uint32_t _utf8_ch;
+    uint8_t _utf8_remaining;
+    uint8_t _utf8_len;
+
+    Stats _stats;
+
+    static inline Terminal init(
+        const uintmax_t width,
+        const uintmax_t height
+    ) {
+        // the zeroed cells read as blanks in the default style
+        return {
+            ._screen = StyledBuffer::init(width, height),
+            ._cursor = {._x = 0, ._y = 0},
+            ._saved_cursor = {._x = 0, ._y = 0},
+            ._wrap_pending = false,
+            ._autowrap = true,
+            ._style = 0,
+            ._last_ch = NO_CHARACTER,
+            ._top = 0,
+            ._bottom = height - 1,
+            ._synchronized = false,
+            ._parser = ParserE::Ground,
+            ._params = {},
+            ._param_c = 0,
+            ._marker = 0,
+            ._intermediate = 0,
+            ._utf8_ch = 0,
+            ._utf8_remaining = 0,
+            ._utf8_len = 0,
+            ._stats = {}
+        };
+    }
+
+    inline uintmax_t width() const {
+        return _screen.box()._width;
+    }
+
+    inline uintmax_t height() const {
+        return _screen.box()._height;
+    }
+};
+
+/**
+ * @brief what a terminal shows of style, the background alpha is only used for compositing
+ **/
+static inline uint64_t visibleStyle(
+    uint64_t style
+) {
+    if(Style::FCFM::getBgMode(style) == Style::ColorMode::FullColor) {
+        Style::FCFM::setFCBgA(style, 0);
+    }
+
+    return style;
+}
+
+/**
+ * @brief the style erased cells get, only the background of style survives
+ **/
+static inline uint64_t erasedStyle(
+    const uint64_t style
+) {
+    const Style::Style current = Style::Style::fromEncoding(style);
+
+    Style::Style erased = {._tag = current._tag, ._bg = current._bg};
+
+    return erased.toEncoding();
+}
+
+static inline void moveCursor(
+    Terminal& term,
+    const uintmax_t x,
+    const uintmax_t y
+) {
+    term._cursor._x = x < term.width() ? x : term.width() - 1;
+    term._cursor._y = y < term.height() ? y : term.height() - 1;
+
+    term._wrap_pending = false;
+}
+
+/**
+ * @brief blanks columns [begin, end) of row y
+ **/
+static void eraseCells(
+    Terminal& term,
+    const uintmax_t y,
+    const uintmax_t begin,
+    const uintmax_t end
+) {
+    const auto style = Style::StyleContainer::createValue(erasedStyle(term._style));
+
+    for(uintmax_t x = begin; x < end && x < term.width(); x++) {
+        term._screen.set(Position::create(x, y), ' ', style);
+    }
+}
+
+/**
+ * @brief moves rows top to bottom (both included) n rows up or down, the rows they leave are erased
+ **/
+static void scrollRows(
+    Terminal& term,
+    const uintmax_t top,
+    const uintmax_t bottom,
+    uintmax_t n,
+    const bool up
+) {
+    const uintmax_t rows = bottom - top + 1;
+
+    if(n > rows) {
+        n = rows;
+    }
+
+    if(up) {
+        term._screen.moveRows(top + n, top, rows - n);
+    } else {
+        term._screen.moveRows(top, top + n, rows - n);
+    }
+
+    const uintmax_t vacated = up ? bottom + 1 - n : top;
+
+    for(uintmax_t y = vacated; y < vacated + n; y++) {
+        eraseCells(term, y, 0, term.width());
+    }
+}
+
+static void lineFeed(
+    Terminal& term
+) {
+    term._wrap_pending = false;
+
+    if(term._cursor._y == term._bottom) {
+        scrollRows(term, term._top, term._bottom, 1, true);
+    } else if(term._cursor._y + 1 < term.height()) {
+        term._cursor._y++;
+    }
+}
+
+static void reverseIndex(
+    Terminal& term
+) {
+    term._wrap_pending = false;
+
+    if(term._cursor._y == term._top) {
+        scrollRows(term, term._top, term._bottom, 1, false);
+    } else if(term._cursor._y > 0) {
+        term._cursor._y--;
+    }
+}
+
+static void putCharacter(
+    Terminal& term,
+    const uint32_t ch
+) {
+    if(term._wrap_pending) {
+        term._cursor._x = 0;
+        lineFeed(term);
+    }
+
+    term._screen.set(term._cursor, ch, Style::StyleContainer::createValue(term._style));
+
+    term._last_ch = ch;
+    term._stats._printed_c++;
+
+    if(term._cursor._x + 1 < term.width()) {
+        term._cursor._x++;
+    } else {
+        term._wrap_pending = term._autowrap;
+    }
+}
+
+/**
+ * @brief ICH and DCH, the cells from the cursor to the end of its row move n columns right over blanks or n columns left
+ **/
+static void shiftCharacters(
+    Terminal& term,
+    const uintmax_t n,
+    const bool insert
+) {
+    const uintmax_t y = term._cursor._y;
+    const uintmax_t x = term._cursor._x;
+    const uintmax_t width = term.width();
+
+    const uintmax_t shift = n < width - x ? n : width - x;
+
+    if(insert) {
+        for(uintmax_t i = width; i-- > x + shift;) {
+            const Position src = Position::create(i - shift, y);
+
+            term._screen.set(Position::create(i, y), term._screen.all().ch(src), term._screen.all().style(src));
+        }
+
+        eraseCells(term, y, x, x + shift);
+    } else {
+        for(uintmax_t i = x; i + shift < width; i++) {
+            const Position src = Position::create(i + shift, y);
+
+            term._screen.set(Position::create(i, y), term._screen.all().ch(src), term._screen.all().style(src));
+        }
+
+        eraseCells(term, y, width - shift, width);
+    }
+
+    term._wrap_pending = false;
+}
+
+/**
+ * @brief IL and DL, they only act inside the scroll region
+ **/
+static void shiftLines(
+    Terminal& term,
+    const uintmax_t n,
+    const bool insert
+) {
+    const uintmax_t y = term._cursor._y;
+
+    if(y < term._top || y > term._bottom) {
+        return;
+    }
+
+    scrollRows(term, y, term._bottom, n, !insert);
+
+    term._cursor._x = 0;
+    term._wrap_pending = false;
+}
+
+static void reset(
+    Terminal& term
+) {
+    term._screen.clearRows(0, term.height());
+
+    term._cursor = {._x = 0, ._y = 0};
+    term._saved_cursor = {._x = 0, ._y = 0};
+    term._wrap_pending = false;
+    term._autowrap = true;
+    term._style = 0;
+    term._last_ch = NO_CHARACTER;
+    term._top = 0;
+    term._bottom = term.height() - 1;
+}
+
+/**
+ * @brief first cell of expected that the terminal does not show at pos, NO_MISMATCH if there is none
+ * styles are compared as visibleStyle(), on both sides a codepoint of 0 is the blank a zeroed buffer stands for
+ **/
+static Position findMismatch(
+    Terminal& term,
+    const StyledBufferArea& expected,
+    const Position& pos
+) {
+    const StyledBufferArea shown = term._screen.all();
+
+    for(uintmax_t y = 0; y < expected.box()._height; y++) {
+        for(uintmax_t x = 0; x < expected.box()._width; x++) {
+            const Position cell = Position::create(x, y);
+            const Position at = pos + cell;
+
+            const uint32_t ch = expected.ch(cell) == 0 ? ' ' : expected.ch(cell);
+            const uint32_t shown_ch = shown.ch(at) == 0 ? ' ' : shown.ch(at);
+
+            if(shown_ch != ch || visibleStyle(shown.styleValue(at)) != visibleStyle(expected.styleValue(cell))) {
+                return at;
+            }
+        }
+    }
+
+    return NO_MISMATCH;
+}
+
+}
+
+}